@@ -0,0 +1,193 @@
+// ==================================================
+// File: src/AlertEngine.cpp
+// ==================================================
+
+#include "AlertEngine.h"
+#include "Send_E-Mail.h"
+#include "Config.h"
+#include <WiFi.h>
+
+struct AlertDefinition
+{
+    const char *key;                          // Dedupe key
+    const char *subject;
+    AlertSeverity severity;
+    unsigned long ladderMs[ALERT_LADDER_STEPS]; // Wait before reminder 1, 2, 3...; 0 = no more reminders
+    uint8_t escalateAfter;                      // Notifications before WARNING becomes DANGER; 0 = never
+};
+
+// Indexed by AlertId
+static const AlertDefinition definitions[ALERT_COUNT] = {
+    {"heater.single", "Single Heater Failure - Attention Needed", ALERT_SEVERITY_WARNING,
+     {3600000, 3600000, 3600000}, 0},             // Hourly
+    {"heater.both", "Both Heater Failure - Attention Needed", ALERT_SEVERITY_WARNING,
+     {1800000, 1800000, 1800000}, 2},             // Every 30 min, DANGER from the third email
+    {"relay.energised", "Heaters Energised With Relay OFF", ALERT_SEVERITY_DANGER,
+     {1800000, 1800000, 1800000}, 0},             // Every 30 min
+    {"relay.leakage", "Leakage Current With Relay OFF", ALERT_SEVERITY_WARNING,
+     {0, 0, 0}, 0},                               // Once
+    {"safety.cutout", "Safety Cutout Tripped - Reset Required", ALERT_SEVERITY_DANGER,
+     {1800000, 3600000, 7200000}, 0},             // 30 min, 1 h, then every 2 h
+};
+
+struct AlertState
+{
+    bool active;
+    bool pending;             // A notification is due
+    bool deferred;            // The pending notification has hit the rate limit
+    uint16_t notifications;
+    unsigned long lastSent;
+    uint32_t rateLimited;
+    char detail[ALERT_DETAIL_LEN];
+};
+
+static AlertState states[ALERT_COUNT];
+
+// Emails attempted in the current fixed rate window; the count restarts
+// every ALERT_RATE_WINDOW_MS rather than sliding
+static unsigned long rateWindowStart = 0;
+static uint8_t rateWindowCount = 0;
+
+static AlertSeverity currentSeverity(AlertId id)
+{
+    const AlertDefinition &def = definitions[id];
+    if (def.escalateAfter && states[id].notifications >= def.escalateAfter)
+    {
+        return ALERT_SEVERITY_DANGER;
+    }
+    return def.severity;
+}
+
+void raiseAlert(AlertId id, const char *detail)
+{
+    if (id >= ALERT_COUNT)
+    {
+        return;
+    }
+    AlertState &state = states[id];
+    strncpy(state.detail, detail, sizeof(state.detail) - 1);
+    state.detail[sizeof(state.detail) - 1] = '\0';
+    if (!state.active)
+    {
+        state.active = true;
+        state.pending = true;
+        state.notifications = 0;
+#if DEBUG_SERIAL
+        Serial.print("Alert raised: ");
+        Serial.println(definitions[id].key);
+#endif
+    }
+}
+
+void clearAlert(AlertId id)
+{
+    if (id >= ALERT_COUNT || !states[id].active)
+    {
+        return;
+    }
+    states[id].active = false;
+    states[id].pending = false;
+    states[id].deferred = false;
+#if DEBUG_SERIAL
+    Serial.print("Alert cleared: ");
+    Serial.println(definitions[id].key);
+#endif
+}
+
+bool isAlertActive(AlertId id)
+{
+    return id < ALERT_COUNT && states[id].active;
+}
+
+/**************************************
+ *   Alert delivery (loop)            *
+ *           start                    *
+ *************************************/
+void processAlerts()
+{
+    unsigned long now = millis();
+    if (now - rateWindowStart >= ALERT_RATE_WINDOW_MS)
+    {
+        rateWindowStart = now;
+        rateWindowCount = 0;
+    }
+
+    for (int i = 0; i < ALERT_COUNT; i++)
+    {
+        AlertId id = (AlertId)i;
+        AlertState &state = states[i];
+        if (!state.active)
+        {
+            continue;
+        }
+
+        // Reminders climb the ladder; the last step repeats
+        if (!state.pending && state.notifications > 0)
+        {
+            uint8_t step = state.notifications - 1;
+            if (step >= ALERT_LADDER_STEPS)
+            {
+                step = ALERT_LADDER_STEPS - 1;
+            }
+            unsigned long wait = definitions[i].ladderMs[step];
+            state.pending = wait && now - state.lastSent >= wait;
+        }
+        if (!state.pending)
+        {
+            continue;
+        }
+
+        // Deferred, not dropped: it goes out once WiFi and the budget allow
+        if (WiFi.status() != WL_CONNECTED)
+        {
+            continue;
+        }
+        if (rateWindowCount >= ALERT_RATE_LIMIT)
+        {
+            if (!state.deferred)
+            {
+                state.deferred = true;
+                state.rateLimited++;
+            }
+            continue;
+        }
+
+        String subject = currentSeverity(id) == ALERT_SEVERITY_DANGER ? "DANGER: " : "WARNING: ";
+        subject += definitions[i].subject;
+        if (state.notifications > 0)
+        {
+            subject += " (reminder ";
+            subject += state.notifications;
+            subject += ")";
+        }
+        // A failed attempt spends the budget too, so a dead mail server is
+        // tried at most ALERT_RATE_LIMIT times per window
+        rateWindowCount++;
+        if (!sendEmail(subject, state.detail))
+        {
+            break; // Still pending; the other alerts wait for the next pass
+        }
+        state.pending = false;
+        state.deferred = false;
+        state.notifications++;
+        state.lastSent = now;
+    }
+}
+/**************************************
+ *   Alert delivery (loop)            *
+ *           end                      *
+ *************************************/
+
+AlertStatus getAlertStatus(AlertId id)
+{
+    AlertStatus status = {"", false, ALERT_SEVERITY_WARNING, 0, 0};
+    if (id < ALERT_COUNT)
+    {
+        status.key = definitions[id].key;
+        status.active = states[id].active;
+        status.severity = currentSeverity(id);
+        status.notifications = states[id].notifications;
+        status.rateLimited = states[id].rateLimited;
+    }
+    return status;
+}
@@ -0,0 +1,47 @@
+// ==================================================
+// File: src/AlertEngine.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+
+// Alerts are raised and cleared by the code that sees the condition and
+// delivered by processAlerts() from loop(). Each AlertId is its own dedupe
+// key: raising an active alert only refreshes its detail text; reminders
+// follow the alert's escalation ladder until it is cleared.
+enum AlertId : uint8_t
+{
+    ALERT_SINGLE_HEATER_FAILED,
+    ALERT_BOTH_HEATERS_FAILED,
+    ALERT_RELAY_ENERGISED_WHEN_OFF,
+    ALERT_RELAY_LEAKAGE,
+    ALERT_SAFETY_CUTOUT,
+    ALERT_COUNT
+};
+
+enum AlertSeverity : uint8_t
+{
+    ALERT_SEVERITY_WARNING,
+    ALERT_SEVERITY_DANGER
+};
+
+#define ALERT_LADDER_STEPS 3           // Reminder intervals per alert; the last one repeats
+#define ALERT_DETAIL_LEN 200           // Email body, including the terminator
+#define ALERT_RATE_WINDOW_MS 3600000   // Rate limit window for all alerts together
+#define ALERT_RATE_LIMIT 6             // Emails per window; excess alerts stay pending
+
+struct AlertStatus
+{
+    const char *key;
+    bool active;
+    AlertSeverity severity; // After escalation
+    uint16_t notifications; // Sent since the alert was raised
+    uint32_t rateLimited;   // Deliveries deferred by the rate limit since boot
+};
+
+// Function declarations (loop() side only)
+void raiseAlert(AlertId id, const char *detail); // Condition present; detail is the email body
+void clearAlert(AlertId id);                     // Condition gone; the next raise notifies at once
+bool isAlertActive(AlertId id);
+void processAlerts();                            // Sends due notifications
+AlertStatus getAlertStatus(AlertId id);
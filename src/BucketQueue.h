@@ -0,0 +1,99 @@
+// ==================================================
+// File: src/BucketQueue.h
+// ==================================================
+// Wall-clock hour/day periods and a small fixed queue of closed buckets
+// waiting to be written, shared by the energy meter and the history
+// rollups. The queue is plain data so it can sit in the RTC/NVS state of
+// its owner and survive reboots. Plain C++ with no Arduino dependencies.
+
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BUCKET_QUEUE_HOURS 24 // Closed hour buckets kept while Firebase is unreachable
+#define BUCKET_QUEUE_DAYS 7   // Closed day buckets kept likewise
+#define BUCKET_RETRY_INTERVAL_MS 30000  // Before retrying a failed bucket write
+#define BUCKET_BACKLOG_INTERVAL_MS 2000 // Between writes while buckets are queued
+
+// A closed bucket and the period it covers
+template <typename Bucket>
+struct ClosedBucket
+{
+    uint32_t dayKey; // YYYYMMDD
+    int32_t hour;    // 0-23, -1 for a day bucket
+    Bucket bucket;
+};
+
+// Oldest first; when full the oldest bucket is dropped, so an outage longer
+// than the queue keeps the most recent periods
+template <typename Bucket, int N>
+struct BucketQueue
+{
+    uint16_t head;  // Index of the oldest bucket
+    uint16_t count; // Buckets waiting
+    uint32_t dropped;
+    ClosedBucket<Bucket> items[N];
+};
+
+template <typename Bucket, int N>
+inline bool bucketQueueValid(const BucketQueue<Bucket, N> &q)
+{
+    return q.head < N && q.count <= N;
+}
+
+template <typename Bucket, int N>
+inline void bucketQueuePush(BucketQueue<Bucket, N> &q, uint32_t dayKey, int32_t hour, const Bucket &bucket)
+{
+    if (q.count == N)
+    {
+        q.head = (q.head + 1) % N;
+        q.count--;
+        q.dropped++;
+    }
+    ClosedBucket<Bucket> &item = q.items[(q.head + q.count) % N];
+    item.dayKey = dayKey;
+    item.hour = hour;
+    item.bucket = bucket;
+    q.count++;
+}
+
+// Oldest waiting bucket; only valid while count > 0
+template <typename Bucket, int N>
+inline const ClosedBucket<Bucket> &bucketQueueFront(const BucketQueue<Bucket, N> &q)
+{
+    return q.items[q.head];
+}
+
+// Drops the oldest bucket once it has been written
+template <typename Bucket, int N>
+inline void bucketQueuePop(BucketQueue<Bucket, N> &q)
+{
+    if (q.count > 0)
+    {
+        q.head = (q.head + 1) % N;
+        q.count--;
+    }
+}
+
+// Local day and hour of an epoch that already carries the local offset
+// (NTPClient). Returns false before the clock has been set.
+inline bool bucketPeriodOf(time_t epoch, uint32_t &dayKey, int32_t &hour)
+{
+    if (epoch <= 1000000000)
+    {
+        return false;
+    }
+    struct tm timeinfo;
+    gmtime_r(&epoch, &timeinfo);
+    dayKey = (timeinfo.tm_year + 1900) * 10000 + (timeinfo.tm_mon + 1) * 100 + timeinfo.tm_mday;
+    hour = timeinfo.tm_hour;
+    return true;
+}
+
+// YYYYMMDD -> "YYYY-MM-DD"
+inline void formatDayKey(uint32_t dayKey, char *buffer, size_t size)
+{
+    snprintf(buffer, size, "%04lu-%02lu-%02lu",
+             (unsigned long)(dayKey / 10000), (unsigned long)(dayKey / 100 % 100), (unsigned long)(dayKey % 100));
+}
@@ -9,6 +9,7 @@ const char* heaterStateToString(HeaterState state) {
         case ONE_HEATER_ON:      return "ONE_HEATER_ON";
         case BOTH_HEATERS_ON:    return "BOTH_HEATERS_ON";
         case BOTH_HEATERS_BLOWN: return "BOTH_HEATERS_BLOWN";
+        case HEATER_ENERGISED_WHEN_OFF: return "HEATER_ENERGISED_WHEN_OFF";
         default:                 return "UNKNOWN_STATE";
     }
 }
\ No newline at end of file
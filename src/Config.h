@@ -52,15 +52,7 @@ enum MQTTState
     MQTT_STATE_ERROR
 };
 
-// Heater state enumeration for multi-heater detection
-enum HeaterState
-{
-    HEATER_STARTUP,    // Initial state during startup
-    HEATERS_OFF,       // <0.45A - No heaters working
-    ONE_HEATER_ON,     // 1.5-3.0A - One heater working
-    BOTH_HEATERS_ON,   // >3.5A - Both heaters working
-    BOTH_HEATERS_BLOWN // ZERO current reading
-};
+#include "HeaterState.h" // Heater state enumeration for multi-heater detection
 // // Function declarations
 const char* heaterStateToString(HeaterState state);
 
@@ -135,14 +127,48 @@ struct SystemStatus
 //=================================================
 
 // Calibration Constants - Updated for 2×100W heaters
+// Defaults only: the classifier table in NVS overrides the calibration and
+// the baseline is re-learned while the relay is off (see HeaterClassifier)
 #define CALIBRATION_CONSTANT 68.3
 #define BASELINE_OFFSET 0.3 // Reduced from 1.75 to match actual readings
 
+// Fundamental-only analysis rejects broadband ADC/WiFi noise, so its
+// offset and noise floor are much lower than the RMS path's
+#define SPECTRAL_BASELINE_OFFSET 0.05
+#define SPECTRAL_NOISE_THRESHOLD 0.05
+
 // Detection Thresholds - Updated for 100W heaters
 #define NOISE_THRESHOLD 0.1
 #define HEATER_OFF_THRESHOLD 0.40
 #define HEATER_ON_THRESHOLD 0.45
 
+// Mains supply
+#define MAINS_FREQUENCY_HZ 50
+#define MAINS_VOLTAGE 230.0 // V, used for energy metering
+
+// Current acquisition: true = continuous DMA sampling in a background task,
+// false = blocking EmonLib calcIrms() on every reading
+#define USE_BACKGROUND_CURRENT_SAMPLER true
+
+// History layout: true = one columnar block per hour under
+// ESP32/history/blocks (see HistoryBlocks.h), false = one node per sample
+// under ESP32/history/daily as read by the current chart hook
+#define HISTORY_BLOCK_MODE false
+
+// PI control (optional, see setHeaterControlMode): the PI output is a duty
+// applied over a slow time-proportioning window
+#define PI_DEFAULT_KP 0.5               // Duty per °C of error
+#define PI_DEFAULT_INTEGRAL_TIME 1200.0 // s
+#define PI_WINDOW_MS 60000
+#define PI_MIN_ON_MS 10000
+#define PI_MIN_OFF_MS 10000
+
+// Safety cutout (see SafetySupervisor.h): latched, independent of the
+// control loop, cleared only by React/control/safetyReset
+#define SAFETY_MAX_TEMP 40.0            // °C on any probe
+#define SAFETY_MAX_ON_MS 14400000       // 4 h of continuous relay on-time
+#define SAFETY_SENSOR_TIMEOUT_MS 30000  // No valid probe reading for this long
+
 // Timing Configuration
 #define SAMPLES_PER_READING 5000
 #define LOG_INTERVAL_MINUTES .5
@@ -155,6 +181,7 @@ struct SystemStatus
 // Function prototypes
 bool voltageSensor();       // Returns true if heater is drawing current, false if not
 double getCurrentReading(); // Returns actual current reading for detailed analysis
-void updateIrmsToFirebase();  // Call periodically to update Firebase with latest Irms value
+double getLastCurrentReading(); // Last value returned by getCurrentReading(), no new measurement
+void updateIrmsToFirebase();  // Pushes the latest Irms value; called once per energy rollup
 
 HeaterState getHeaterState(double current);
\ No newline at end of file
@@ -0,0 +1,204 @@
+// ==================================================
+// File: src/ControlInput.cpp
+// ==================================================
+
+#include "ControlInput.h"
+
+static ControlPolicy policy = CONTROL_POLICY_PRIMARY_FALLBACK;
+static float weights[PROBE_ROLE_COUNT] = {1.0, 0.5, 0.5}; // Red, Blue, Green
+static ControlInput lastInput = {NAN, false, 0, 0, CONTROL_POLICY_PRIMARY_FALLBACK};
+
+// Median of three with missing values; returns NAN if none are usable
+static float medianOf(const float values[PROBE_ROLE_COUNT], const bool usable[PROBE_ROLE_COUNT])
+{
+    float v[PROBE_ROLE_COUNT];
+    int n = 0;
+    for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+    {
+        if (usable[r])
+        {
+            v[n++] = values[r];
+        }
+    }
+    if (n == 0)
+    {
+        return NAN;
+    }
+    if (n == 1)
+    {
+        return v[0];
+    }
+    if (n == 2)
+    {
+        return (v[0] + v[1]) / 2.0f;
+    }
+    // Three values: the median is the one that is neither min nor max
+    return fmaxf(fminf(v[0], v[1]), fminf(fmaxf(v[0], v[1]), v[2]));
+}
+
+/**************************************
+ *   Combine probes into one input    *
+ *           start                    *
+ *************************************/
+// Constant time: a fixed pass over the three probe roles. With all three
+// probes valid, any probe more than CONTROL_OUTLIER_LIMIT from the median
+// is dropped before the policy is applied. With two probes there is no
+// majority, so both are kept.
+ControlInput evaluateControlInput()
+{
+    float values[PROBE_ROLE_COUNT];
+    bool usable[PROBE_ROLE_COUNT];
+    int validCount = 0;
+
+    for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+    {
+        values[r] = getTemperature(r);
+        usable[r] = !isnan(values[r]);
+        if (usable[r])
+        {
+            validCount++;
+        }
+    }
+
+    ControlInput input = {NAN, false, 0, 0, policy};
+
+    if (validCount == PROBE_ROLE_COUNT)
+    {
+        float median = medianOf(values, usable);
+        for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+        {
+            if (fabs(values[r] - median) > CONTROL_OUTLIER_LIMIT)
+            {
+                usable[r] = false;
+                input.rejectedMask |= (1 << r);
+            }
+        }
+    }
+
+    switch (policy)
+    {
+    case CONTROL_POLICY_PRIMARY_FALLBACK:
+        for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+        {
+            if (usable[r])
+            {
+                input.temperature = values[r];
+                input.driverMask = (1 << r);
+                break;
+            }
+        }
+        break;
+
+    case CONTROL_POLICY_MEDIAN:
+        input.temperature = medianOf(values, usable);
+        for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+        {
+            if (usable[r])
+            {
+                input.driverMask |= (1 << r);
+            }
+        }
+        break;
+
+    case CONTROL_POLICY_WEIGHTED:
+    {
+        float sum = 0;
+        float weightSum = 0;
+        for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+        {
+            if (usable[r] && weights[r] > 0)
+            {
+                sum += values[r] * weights[r];
+                weightSum += weights[r];
+                input.driverMask |= (1 << r);
+            }
+        }
+        if (weightSum > 0)
+        {
+            input.temperature = sum / weightSum;
+        }
+        break;
+    }
+    }
+
+    input.valid = !isnan(input.temperature);
+    lastInput = input;
+    return input;
+}
+/**************************************
+ *   Combine probes into one input    *
+ *           end                      *
+ *************************************/
+
+const ControlInput &getLastControlInput()
+{
+    return lastInput;
+}
+
+void setControlPolicy(ControlPolicy newPolicy)
+{
+    policy = newPolicy;
+}
+
+ControlPolicy getControlPolicy()
+{
+    return policy;
+}
+
+void setControlWeights(const float newWeights[PROBE_ROLE_COUNT])
+{
+    for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+    {
+        weights[r] = (newWeights[r] > 0) ? newWeights[r] : 0;
+    }
+}
+
+const char *controlPolicyToString(ControlPolicy p)
+{
+    switch (p)
+    {
+    case CONTROL_POLICY_PRIMARY_FALLBACK: return "primary";
+    case CONTROL_POLICY_MEDIAN:           return "median";
+    case CONTROL_POLICY_WEIGHTED:         return "weighted";
+    default:                              return "unknown";
+    }
+}
+
+bool parseControlPolicy(const String &text, ControlPolicy &p)
+{
+    if (text == "primary")
+    {
+        p = CONTROL_POLICY_PRIMARY_FALLBACK;
+    }
+    else if (text == "median")
+    {
+        p = CONTROL_POLICY_MEDIAN;
+    }
+    else if (text == "weighted")
+    {
+        p = CONTROL_POLICY_WEIGHTED;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// Formats a probe mask as e.g. "Red+Blue", or "none"
+void describeControlDrivers(uint8_t mask, char *buffer, size_t size)
+{
+    size_t len = 0;
+    buffer[0] = '\0';
+    for (int r = 0; r < PROBE_ROLE_COUNT && len < size; r++)
+    {
+        if (mask & (1 << r))
+        {
+            len += snprintf(buffer + len, size - len, "%s%s", len ? "+" : "", probeRoleToString((ProbeRole)r));
+        }
+    }
+    if (len == 0)
+    {
+        snprintf(buffer, size, "none");
+    }
+}
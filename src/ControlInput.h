@@ -0,0 +1,37 @@
+// ==================================================
+// File: src/ControlInput.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "TemperatureSensors.h"
+
+// How the probes are combined into the temperature the heater is controlled on
+enum ControlPolicy : uint8_t
+{
+    CONTROL_POLICY_PRIMARY_FALLBACK, // Red, else Blue, else Green
+    CONTROL_POLICY_MEDIAN,           // Median of the usable probes
+    CONTROL_POLICY_WEIGHTED          // Weighted mean of the usable probes
+};
+
+#define CONTROL_OUTLIER_LIMIT 5.0 // °C from the median before a probe is ignored
+
+// Result of one evaluation; masks have one bit per ProbeRole
+struct ControlInput
+{
+    float temperature;    // NAN if no probe could be used
+    bool valid;
+    uint8_t driverMask;   // Probes that produced the temperature
+    uint8_t rejectedMask; // Valid probes dropped as outliers
+    ControlPolicy policy;
+};
+
+// Function declarations
+ControlInput evaluateControlInput();
+const ControlInput &getLastControlInput();
+void setControlPolicy(ControlPolicy policy);
+ControlPolicy getControlPolicy();
+void setControlWeights(const float weights[PROBE_ROLE_COUNT]);
+const char *controlPolicyToString(ControlPolicy policy);
+bool parseControlPolicy(const String &text, ControlPolicy &policy);
+void describeControlDrivers(uint8_t mask, char *buffer, size_t size);
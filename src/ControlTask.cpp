@@ -0,0 +1,171 @@
+// ==================================================
+// File: src/ControlTask.cpp
+// ==================================================
+
+#include "ControlTask.h"
+#include "TemperatureSensors.h"
+
+static TaskHandle_t controlTask = NULL;
+static QueueHandle_t commandQueue = NULL;
+static QueueHandle_t eventQueue = NULL;
+
+static ControlTaskStats stats = {};
+static portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Local time handed over from loop(), which owns the NTP client
+static time_t clockEpoch = 0;
+static unsigned long clockMillis = 0;
+static bool clockSet = false;
+static portMUX_TYPE clockLock = portMUX_INITIALIZER_UNLOCKED;
+
+static void applyControlCommand(const ControlCommand &command)
+{
+    switch (command.type)
+    {
+    case CONTROL_CMD_MODE:
+        setHeaterControlMode(command.mode);
+        break;
+    case CONTROL_CMD_PI_TUNING:
+        setPiTuning(command.values[0], command.values[1]);
+        break;
+    case CONTROL_CMD_INPUT_POLICY:
+        setControlPolicy(command.policy);
+        break;
+    case CONTROL_CMD_INPUT_WEIGHTS:
+        setControlWeights(command.values);
+        break;
+    }
+}
+
+/**************************************
+ *   Fixed-period control task        *
+ *           start                    *
+ *************************************/
+static void controlTaskLoop(void *parameter)
+{
+    const uint32_t periodUs = CONTROL_TASK_PERIOD_MS * 1000UL;
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t previousStart = micros();
+    uint32_t tick = 0;
+
+    for (;;)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CONTROL_TASK_PERIOD_MS));
+        uint32_t start = micros();
+        uint32_t interval = start - previousStart;
+        previousStart = start;
+
+        ControlCommand command;
+        while (xQueueReceive(commandQueue, &command, 0) == pdTRUE)
+        {
+            applyControlCommand(command);
+        }
+
+        updateTemperatureSensors(); // One 1-Wire step
+        if (++tick % CONTROL_DECISION_TICKS == 0)
+        {
+            runHeaterControl();
+        }
+
+        uint32_t exec = micros() - start;
+        uint32_t jitter = (interval > periodUs) ? interval - periodUs : periodUs - interval;
+        portENTER_CRITICAL(&statsLock);
+        stats.ticks++;
+        if (stats.ticks > 1) // The first interval includes task start-up
+        {
+            stats.lastJitterUs = jitter;
+            if (jitter > stats.maxJitterUs)
+            {
+                stats.maxJitterUs = jitter;
+            }
+        }
+        stats.lastExecUs = exec;
+        if (exec > stats.maxExecUs)
+        {
+            stats.maxExecUs = exec;
+        }
+        if (exec > periodUs)
+        {
+            stats.overruns++;
+        }
+        portEXIT_CRITICAL(&statsLock);
+    }
+}
+/**************************************
+ *   Fixed-period control task        *
+ *           end                      *
+ *************************************/
+
+bool initControlTask()
+{
+    if (controlTask != NULL)
+    {
+        return true;
+    }
+    commandQueue = xQueueCreate(CONTROL_COMMAND_QUEUE_LENGTH, sizeof(ControlCommand));
+    eventQueue = xQueueCreate(CONTROL_EVENT_QUEUE_LENGTH, sizeof(ControlEvent));
+    if (commandQueue == NULL || eventQueue == NULL)
+    {
+        Serial.println("Control task: queue allocation failed");
+        return false;
+    }
+    xTaskCreatePinnedToCore(controlTaskLoop, "control", CONTROL_TASK_STACK, NULL,
+                            CONTROL_TASK_PRIORITY, &controlTask, CONTROL_TASK_CORE);
+    Serial.println("Control task running");
+    return controlTask != NULL;
+}
+
+bool postControlCommand(const ControlCommand &command)
+{
+    if (commandQueue != NULL && xQueueSend(commandQueue, &command, 0) == pdTRUE)
+    {
+        return true;
+    }
+    portENTER_CRITICAL(&statsLock);
+    stats.commandsDropped++;
+    portEXIT_CRITICAL(&statsLock);
+    return false;
+}
+
+bool postControlEvent(const ControlEvent &event)
+{
+    if (eventQueue != NULL && xQueueSend(eventQueue, &event, 0) == pdTRUE)
+    {
+        return true;
+    }
+    portENTER_CRITICAL(&statsLock);
+    stats.eventsDropped++;
+    portEXIT_CRITICAL(&statsLock);
+    return false;
+}
+
+bool receiveControlEvent(ControlEvent &event)
+{
+    return eventQueue != NULL && xQueueReceive(eventQueue, &event, 0) == pdTRUE;
+}
+
+void setControlClock(time_t localEpoch)
+{
+    portENTER_CRITICAL(&clockLock);
+    clockEpoch = localEpoch;
+    clockMillis = millis();
+    clockSet = true;
+    portEXIT_CRITICAL(&clockLock);
+}
+
+bool getControlLocalTime(time_t &localEpoch)
+{
+    portENTER_CRITICAL(&clockLock);
+    bool valid = clockSet;
+    localEpoch = clockEpoch + (millis() - clockMillis) / 1000;
+    portEXIT_CRITICAL(&clockLock);
+    return valid;
+}
+
+ControlTaskStats getControlTaskStats()
+{
+    portENTER_CRITICAL(&statsLock);
+    ControlTaskStats copy = stats;
+    portEXIT_CRITICAL(&statsLock);
+    return copy;
+}
@@ -0,0 +1,78 @@
+// ==================================================
+// File: src/ControlTask.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include <TimeLib.h>
+#include "Config.h"
+#include "HeaterControl.h"
+#include "ControlInput.h"
+
+// Sensing and relay control run in their own task, so a stalled TLS
+// connect or an email retry in loop() can no longer hold the heater in
+// whatever state it was in. loop() talks to the task only through the
+// two bounded queues below and lock-protected snapshots.
+#define CONTROL_TASK_PERIOD_MS 100  // Sensor acquisition step
+#define CONTROL_DECISION_TICKS 10   // Relay decision every 10 periods (1 s)
+#define CONTROL_TASK_PRIORITY 3     // Above loop() (1) on the same core
+#define CONTROL_TASK_CORE 1         // WiFi and the current sampler live on core 0
+#define CONTROL_TASK_STACK 8192
+#define CONTROL_COMMAND_QUEUE_LENGTH 8
+#define CONTROL_EVENT_QUEUE_LENGTH 16
+
+// loop() -> control task
+enum ControlCommandType : uint8_t
+{
+    CONTROL_CMD_MODE,          // mode
+    CONTROL_CMD_PI_TUNING,     // values[0] = kp, values[1] = integral time (s)
+    CONTROL_CMD_INPUT_POLICY,  // policy
+    CONTROL_CMD_INPUT_WEIGHTS  // values[] per probe role
+};
+
+struct ControlCommand
+{
+    ControlCommandType type;
+    union
+    {
+        HeaterControlMode mode;
+        ControlPolicy policy;
+        float values[PROBE_ROLE_COUNT];
+    };
+};
+
+// Control task -> loop()
+enum ControlEventType : uint8_t
+{
+    CONTROL_EVT_INPUT_CHANGED,  // code = driver mask
+    CONTROL_EVT_RELAY_FAULT     // code = RelayFault, value = off-state current (A)
+};
+
+struct ControlEvent
+{
+    ControlEventType type;
+    uint8_t code;
+    float value;
+};
+
+// Period jitter and execution time, in microseconds
+struct ControlTaskStats
+{
+    uint32_t ticks;
+    uint32_t lastJitterUs;  // |actual - nominal| time between wake-ups
+    uint32_t maxJitterUs;
+    uint32_t lastExecUs;
+    uint32_t maxExecUs;     // Worst-case execution time seen
+    uint32_t overruns;      // Ticks that ran longer than the period
+    uint32_t commandsDropped;
+    uint32_t eventsDropped;
+};
+
+// Function declarations
+bool initControlTask();
+bool postControlCommand(const ControlCommand &command); // Never blocks; false when the queue is full
+bool postControlEvent(const ControlEvent &event);       // Control task only; never blocks
+bool receiveControlEvent(ControlEvent &event);          // loop(); false when nothing is pending
+void setControlClock(time_t localEpoch);                // loop() feeds NTP time to the task
+bool getControlLocalTime(time_t &localEpoch);
+ControlTaskStats getControlTaskStats();
@@ -0,0 +1,115 @@
+// ==================================================
+// File: src/CurrentMath.h
+// ==================================================
+// Fixed-point signal processing for the SCT-013 current input.
+// Plain C++ with no Arduino or ESP-IDF dependencies, so it compiles on a
+// host and can be fed recorded or synthetic ADC samples.
+
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// Running RMS over a window of ADC samples.
+// The mid-rail offset is tracked with the same 1/1024 low-pass EmonLib
+// uses, held in Q16. Samples are squared in Q2 (0.25-count steps), so a
+// full-scale 12-bit swing squares to < 2^28 and a window mean fits 32 bits.
+struct RmsAccumulator
+{
+    int32_t offsetQ16;   // Mid-rail estimate, ADC counts in Q16
+    uint64_t sumSquares; // Sum of squared centred samples in Q4 (counts^2 * 16)
+    uint32_t samples;    // Samples in the current window
+    uint32_t windowSize; // Samples per window
+};
+
+inline void rmsInit(RmsAccumulator &acc, uint32_t windowSize, uint16_t midpoint)
+{
+    acc.offsetQ16 = (int32_t)midpoint << 16;
+    acc.sumSquares = 0;
+    acc.samples = 0;
+    acc.windowSize = windowSize;
+}
+
+// Removes the DC offset from a raw sample; result in Q2 counts
+inline int32_t rmsCentre(RmsAccumulator &acc, uint16_t raw)
+{
+    int32_t x = ((int32_t)raw << 16) - acc.offsetQ16;
+    acc.offsetQ16 += x >> 10;
+    return x >> 14;
+}
+
+// Adds one raw sample. Returns true when a window completes, with its
+// mean square (Q4 counts^2) in meanSquare; the next window starts empty.
+inline bool rmsAddCentred(RmsAccumulator &acc, int32_t centredQ2, uint32_t &meanSquare)
+{
+    acc.sumSquares += (uint64_t)((int64_t)centredQ2 * centredQ2);
+    if (++acc.samples < acc.windowSize)
+    {
+        return false;
+    }
+    meanSquare = (uint32_t)(acc.sumSquares / acc.samples);
+    acc.sumSquares = 0;
+    acc.samples = 0;
+    return true;
+}
+
+// Drops a partial window, e.g. after the ADC was paused; keeps the offset
+inline void rmsRestart(RmsAccumulator &acc)
+{
+    acc.sumSquares = 0;
+    acc.samples = 0;
+}
+
+inline bool rmsAddSample(RmsAccumulator &acc, uint16_t raw, uint32_t &meanSquare)
+{
+    return rmsAddCentred(acc, rmsCentre(acc, raw), meanSquare);
+}
+
+// Single-bin DFT (Goertzel) on centred Q2 samples. The coefficient
+// 2*cos(2*pi*f/fs) is held in Q28: at Q14 its rounding detuned the harmonic
+// bins enough for the fundamental to leak ~1 count into them. The state is
+// 64 bits, so a window of tens of thousands of full-scale samples cannot
+// overflow. Bins are exact when the window spans a whole number of mains
+// cycles.
+struct GoertzelBin
+{
+    int64_t coeffQ28;
+    int64_t s1;
+    int64_t s2;
+};
+
+inline void goertzelInit(GoertzelBin &bin, double frequency, double sampleRate)
+{
+    bin.coeffQ28 = llround(2.0 * cos(2.0 * M_PI * frequency / sampleRate) * 268435456.0);
+    bin.s1 = 0;
+    bin.s2 = 0;
+}
+
+inline void goertzelAdd(GoertzelBin &bin, int32_t centredQ2)
+{
+    int64_t s0 = centredQ2 + ((bin.coeffQ28 * bin.s1) >> 28) - bin.s2;
+    bin.s2 = bin.s1;
+    bin.s1 = s0;
+}
+
+inline void goertzelRestart(GoertzelBin &bin)
+{
+    bin.s1 = 0;
+    bin.s2 = 0;
+}
+
+// RMS (in ADC counts) of the bin's sinusoid over a window of n samples;
+// clears the state for the next window
+inline double goertzelRmsCounts(GoertzelBin &bin, uint32_t n)
+{
+    double s1 = (double)bin.s1;
+    double s2 = (double)bin.s2;
+    double power = s1 * s1 + s2 * s2 - (bin.coeffQ28 / 268435456.0) * s1 * s2;
+    bin.s1 = 0;
+    bin.s2 = 0;
+    if (power < 0 || n == 0)
+    {
+        return 0.0;
+    }
+    // |X| = A*n/2 for amplitude A; RMS = A/sqrt(2); Q2 -> counts
+    return sqrt(power) * M_SQRT2 / n / 4.0;
+}
@@ -0,0 +1,229 @@
+// ==================================================
+// File: src/CurrentSampler.cpp
+// ==================================================
+
+#include "CurrentSampler.h"
+#include "CurrentMath.h"
+#include <driver/i2s.h>
+#include <driver/adc.h>
+
+// CURRENT_SENSOR_PIN (GPIO33) is ADC1 channel 5; the I2S ADC mode only
+// supports ADC1, which also keeps working while WiFi is active.
+#define CURRENT_ADC_CHANNEL ADC1_CHANNEL_5
+#define CURRENT_DMA_BUFFER_SAMPLES 256
+
+// ADC counts to amps, as EmonLib computes I_RATIO for a 3.3 V supply.
+// Written from loop() (MQTT calibration) and read by the control task; a
+// float so the store is a single atomic 32-bit write.
+static volatile float ampsPerCount = CALIBRATION_CONSTANT * (3.3 / 4096.0);
+
+static TaskHandle_t samplerTask = NULL;
+static RmsAccumulator accumulator;
+static GoertzelBin fundamentalBin;
+static GoertzelBin harmonic3Bin;
+static GoertzelBin harmonic5Bin;
+static volatile CurrentAnalysisMode analysisMode = CURRENT_MODE_BROADBAND;
+static volatile bool samplerIdle = true; // The relay starts OFF
+
+// Written by the sampler task only; 32-bit stores are atomic on the ESP32.
+// Values are RMS in ADC counts.
+static volatile uint32_t latestMeanSquare = 0;
+static volatile float latestFundamental = 0;
+static volatile float latestHarmonic3 = 0;
+static volatile float latestHarmonic5 = 0;
+static volatile uint32_t windowCount = 0;
+
+// Closes a window: reads out the bins and picks the next window length
+static void completeWindow(uint32_t meanSquare, uint32_t samples)
+{
+    latestMeanSquare = meanSquare;
+    latestFundamental = goertzelRmsCounts(fundamentalBin, samples);
+    latestHarmonic3 = goertzelRmsCounts(harmonic3Bin, samples);
+    latestHarmonic5 = goertzelRmsCounts(harmonic5Bin, samples);
+    windowCount = windowCount + 1;
+
+    accumulator.windowSize = CURRENT_SAMPLES_PER_CYCLE *
+                             (analysisMode == CURRENT_MODE_FUNDAMENTAL ? CURRENT_SPECTRAL_WINDOW_CYCLES : CURRENT_WINDOW_CYCLES);
+}
+
+// Idle duty cycle: stop the ADC and DMA until the next window is due, or
+// until setCurrentSamplerIdle(false) wakes the task early
+static void pauseSampling()
+{
+    i2s_adc_disable(I2S_NUM_0);
+    i2s_stop(I2S_NUM_0);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CURRENT_IDLE_PERIOD_MS));
+    i2s_adc_enable(I2S_NUM_0);
+    i2s_start(I2S_NUM_0);
+
+    // The next window must only contain samples taken after the restart
+    rmsRestart(accumulator);
+    goertzelRestart(fundamentalBin);
+    goertzelRestart(harmonic3Bin);
+    goertzelRestart(harmonic5Bin);
+}
+
+static void currentSamplerTask(void *parameter)
+{
+    uint16_t buffer[CURRENT_DMA_BUFFER_SAMPLES];
+    bool discardNext = false;
+
+    for (;;)
+    {
+        size_t bytesRead = 0;
+        i2s_read(I2S_NUM_0, buffer, sizeof(buffer), &bytesRead, portMAX_DELAY);
+
+        // First buffer after a restart holds ADC settling samples
+        if (discardNext)
+        {
+            discardNext = false;
+            continue;
+        }
+
+        bool windowDone = false;
+        for (size_t i = 0; i < bytesRead / sizeof(uint16_t); i++)
+        {
+            // Top 4 bits carry the channel number, low 12 bits the sample
+            int32_t centred = rmsCentre(accumulator, buffer[i] & 0x0FFF);
+            goertzelAdd(fundamentalBin, centred);
+            goertzelAdd(harmonic3Bin, centred);
+            goertzelAdd(harmonic5Bin, centred);
+
+            uint32_t samples = accumulator.windowSize;
+            uint32_t meanSquare;
+            if (rmsAddCentred(accumulator, centred, meanSquare))
+            {
+                completeWindow(meanSquare, samples);
+                windowDone = true;
+            }
+        }
+
+        if (windowDone && samplerIdle)
+        {
+            pauseSampling();
+            discardNext = true;
+        }
+    }
+}
+
+/**************************************
+ *   Start the background sampler     *
+ *           start                    *
+ *************************************/
+bool initCurrentSampler()
+{
+    if (samplerTask != NULL)
+    {
+        return true;
+    }
+
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+    config.sample_rate = CURRENT_SAMPLE_RATE;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    config.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+    config.dma_buf_count = 4;
+    config.dma_buf_len = CURRENT_DMA_BUFFER_SAMPLES;
+    config.use_apll = false;
+
+    if (i2s_driver_install(I2S_NUM_0, &config, 0, NULL) != ESP_OK)
+    {
+        Serial.println("Current sampler: I2S driver install failed");
+        return false;
+    }
+    i2s_set_adc_mode(ADC_UNIT_1, CURRENT_ADC_CHANNEL);
+    adc1_config_channel_atten(CURRENT_ADC_CHANNEL, ADC_ATTEN_DB_11);
+    i2s_adc_enable(I2S_NUM_0);
+
+    rmsInit(accumulator, CURRENT_WINDOW_SAMPLES, 2048);
+    goertzelInit(fundamentalBin, MAINS_FREQUENCY_HZ, CURRENT_SAMPLE_RATE);
+    goertzelInit(harmonic3Bin, 3 * MAINS_FREQUENCY_HZ, CURRENT_SAMPLE_RATE);
+    goertzelInit(harmonic5Bin, 5 * MAINS_FREQUENCY_HZ, CURRENT_SAMPLE_RATE);
+
+    // Core 0, away from loop(); low priority so WiFi keeps precedence
+    xTaskCreatePinnedToCore(currentSamplerTask, "currentSampler", 4096, NULL, 2, &samplerTask, 0);
+    Serial.println("Current sampler running");
+    return samplerTask != NULL;
+}
+/**************************************
+ *   Start the background sampler     *
+ *           end                      *
+ *************************************/
+
+bool isCurrentSamplerRunning()
+{
+    return samplerTask != NULL;
+}
+
+// O(1): reads the latest window's result for the active mode
+double getSampledIrms()
+{
+    double scale = ampsPerCount;
+    if (analysisMode == CURRENT_MODE_FUNDAMENTAL)
+    {
+        return latestFundamental * scale;
+    }
+    double rmsCounts = sqrt((double)latestMeanSquare) / 4.0; // Q4 -> counts
+    return rmsCounts * scale;
+}
+
+CurrentSpectrum getCurrentSpectrum()
+{
+    CurrentSpectrum spectrum;
+    float scale = ampsPerCount; // One calibration for the whole spectrum
+    spectrum.totalRms = sqrt((double)latestMeanSquare) / 4.0 * scale;
+    spectrum.fundamentalRms = latestFundamental * scale;
+    spectrum.harmonic3Rms = latestHarmonic3 * scale;
+    spectrum.harmonic5Rms = latestHarmonic5 * scale;
+    spectrum.thdPercent = 0;
+    if (spectrum.fundamentalRms > 0)
+    {
+        spectrum.thdPercent = 100.0f * sqrtf(spectrum.harmonic3Rms * spectrum.harmonic3Rms +
+                                             spectrum.harmonic5Rms * spectrum.harmonic5Rms) /
+                              spectrum.fundamentalRms;
+    }
+    return spectrum;
+}
+
+void setCurrentCalibration(double calibration)
+{
+    ampsPerCount = (float)(calibration * (3.3 / 4096.0));
+}
+
+// Takes effect at the next window boundary
+void setCurrentAnalysisMode(CurrentAnalysisMode mode)
+{
+    analysisMode = mode;
+}
+
+CurrentAnalysisMode getCurrentAnalysisMode()
+{
+    return analysisMode;
+}
+
+const char *currentAnalysisModeToString(CurrentAnalysisMode mode)
+{
+    switch (mode)
+    {
+    case CURRENT_MODE_BROADBAND:   return "rms";
+    case CURRENT_MODE_FUNDAMENTAL: return "fundamental";
+    default:                       return "unknown";
+    }
+}
+
+void setCurrentSamplerIdle(bool idle)
+{
+    bool wake = samplerIdle && !idle;
+    samplerIdle = idle;
+    if (wake && samplerTask != NULL)
+    {
+        xTaskNotifyGive(samplerTask); // Cut a pending pause short
+    }
+}
+
+uint32_t getCurrentWindowCount()
+{
+    return windowCount;
+}
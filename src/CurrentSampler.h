@@ -0,0 +1,45 @@
+// ==================================================
+// File: src/CurrentSampler.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Background current acquisition: the ADC runs continuously through the
+// I2S DMA engine and a dedicated task folds the samples into RMS windows.
+#define CURRENT_SAMPLE_RATE 10000 // Hz
+#define CURRENT_WINDOW_CYCLES 10  // Whole mains cycles per RMS window
+#define CURRENT_SPECTRAL_WINDOW_CYCLES 4 // Shorter window is enough for the fundamental
+#define CURRENT_IDLE_PERIOD_MS 2000 // While idle, one window this often with the ADC paused in between
+#define CURRENT_SAMPLES_PER_CYCLE (CURRENT_SAMPLE_RATE / MAINS_FREQUENCY_HZ)
+#define CURRENT_WINDOW_SAMPLES (CURRENT_SAMPLES_PER_CYCLE * CURRENT_WINDOW_CYCLES)
+
+// What getCurrentReading() reports
+enum CurrentAnalysisMode : uint8_t
+{
+    CURRENT_MODE_BROADBAND,  // True RMS of everything the ADC sees (EmonLib equivalent)
+    CURRENT_MODE_FUNDAMENTAL // RMS of the mains-frequency component only
+};
+
+// Result of the latest window, in amps before baseline correction
+struct CurrentSpectrum
+{
+    float totalRms;       // Broadband RMS
+    float fundamentalRms; // Mains-frequency component
+    float harmonic3Rms;   // 3rd harmonic
+    float harmonic5Rms;   // 5th harmonic
+    float thdPercent;     // sqrt(h3^2 + h5^2) / fundamental
+};
+
+// Function declarations
+bool initCurrentSampler();
+bool isCurrentSamplerRunning();
+double getSampledIrms();           // Latest window in the active mode, amps before baseline correction
+uint32_t getCurrentWindowCount();  // Completed windows since boot
+void setCurrentCalibration(double calibration); // CT calibration constant (EmonLib ICAL)
+void setCurrentAnalysisMode(CurrentAnalysisMode mode);
+CurrentAnalysisMode getCurrentAnalysisMode();
+const char *currentAnalysisModeToString(CurrentAnalysisMode mode);
+CurrentSpectrum getCurrentSpectrum();
+void setCurrentSamplerIdle(bool idle); // Duty-cycled windows (relay off) or continuous (relay on)
@@ -0,0 +1,226 @@
+// ==================================================
+// File: src/EnergyMeter.cpp
+// ==================================================
+
+#include "EnergyMeter.h"
+#include "BucketQueue.h"
+#include <Preferences.h>
+#include "TimeManager.h"
+#include "FirebaseService.h"
+#include "MQTTManager.h"
+
+#define ENERGY_STATE_MAGIC 0x454E5232 // "ENR2"
+
+// Everything needed to resume after a reboot, including closed buckets
+// still waiting for Firebase
+struct EnergyState
+{
+    uint32_t magic;
+    uint32_t dayKey; // YYYYMMDD of the open day bucket, 0 before the clock is set
+    int32_t hour;    // Hour of the open hour bucket, -1 before the clock is set
+    EnergyBucket hourBucket;
+    EnergyBucket dayBucket;
+    BucketQueue<EnergyBucket, BUCKET_QUEUE_HOURS> closedHours;
+    BucketQueue<EnergyBucket, BUCKET_QUEUE_DAYS> closedDays;
+};
+
+// Survives a soft reset in RTC memory; NVS covers power loss
+RTC_NOINIT_ATTR static EnergyState state;
+
+static unsigned long lastUpdate = 0;
+static unsigned long lastSave = 0;
+
+static void saveEnergyState()
+{
+    Preferences prefs;
+    prefs.begin("energy", false);
+    prefs.putBytes("state", &state, sizeof(state));
+    prefs.end();
+    lastSave = millis();
+}
+
+float energyDutyPercent(const EnergyBucket &bucket)
+{
+    return bucket.elapsedMs ? 100.0f * bucket.onMs / bucket.elapsedMs : 0.0f;
+}
+
+/**************************************
+ *   Publish closed rollup buckets    *
+ *           start                    *
+ *************************************/
+// One Firebase write and one MQTT publish per closed bucket, oldest first
+// and one bucket of each kind per pass; replaces the per-loop IrmsReading
+// write. A bucket leaves the queue only once Firebase has accepted it.
+static void publishPendingRollups()
+{
+    static unsigned long lastAttempt = 0;
+    static unsigned long retryInterval = 0;
+    if (!fbInitialized || (lastAttempt != 0 && millis() - lastAttempt < retryInterval))
+    {
+        return;
+    }
+    lastAttempt = millis();
+    retryInterval = BUCKET_BACKLOG_INTERVAL_MS;
+
+    char dateKey[16];
+    char path[64];
+    char payload[96];
+    bool changed = false;
+
+    if (state.closedHours.count > 0)
+    {
+        const ClosedBucket<EnergyBucket> &closed = bucketQueueFront(state.closedHours);
+        formatDayKey(closed.dayKey, dateKey, sizeof(dateKey));
+        snprintf(path, sizeof(path), "ESP32/energy/hourly/%s/%02ld", dateKey, (long)closed.hour);
+
+        FirebaseJson json;
+        json.set("kWh", closed.bucket.wattHours / 1000.0f);
+        json.set("duty", energyDutyPercent(closed.bucket));
+        if (Firebase.RTDB.setJSON(&fbData, path, &json))
+        {
+            snprintf(payload, sizeof(payload), "{\"date\":\"%s\",\"hour\":%ld,\"kWh\":%.4f,\"duty\":%.1f}",
+                     dateKey, (long)closed.hour, closed.bucket.wattHours / 1000.0f, energyDutyPercent(closed.bucket));
+            publishSingleValue(TOPIC_ENERGY_HOURLY, payload);
+            bucketQueuePop(state.closedHours);
+            changed = true;
+            if (state.closedHours.count == 0)
+            {
+                updateIrmsToFirebase();
+            }
+        }
+        else
+        {
+            retryInterval = BUCKET_RETRY_INTERVAL_MS;
+        }
+    }
+
+    if (state.closedDays.count > 0)
+    {
+        const ClosedBucket<EnergyBucket> &closed = bucketQueueFront(state.closedDays);
+        formatDayKey(closed.dayKey, dateKey, sizeof(dateKey));
+        snprintf(path, sizeof(path), "ESP32/energy/daily/%s", dateKey);
+
+        FirebaseJson json;
+        json.set("kWh", closed.bucket.wattHours / 1000.0f);
+        json.set("duty", energyDutyPercent(closed.bucket));
+        if (Firebase.RTDB.setJSON(&fbData, path, &json))
+        {
+            snprintf(payload, sizeof(payload), "{\"date\":\"%s\",\"kWh\":%.3f,\"duty\":%.1f}",
+                     dateKey, closed.bucket.wattHours / 1000.0f, energyDutyPercent(closed.bucket));
+            publishSingleValue(TOPIC_ENERGY_DAILY, payload);
+            bucketQueuePop(state.closedDays);
+            changed = true;
+        }
+        else
+        {
+            retryInterval = BUCKET_RETRY_INTERVAL_MS;
+        }
+    }
+
+    if (changed)
+    {
+        saveEnergyState(); // Written buckets must not be replayed after a power loss
+    }
+}
+/**************************************
+ *   Publish closed rollup buckets    *
+ *           end                      *
+ *************************************/
+
+void initEnergyMeter()
+{
+    if (state.magic != ENERGY_STATE_MAGIC)
+    {
+        // Cold boot: RTC memory is garbage, fall back to the last checkpoint
+        Preferences prefs;
+        prefs.begin("energy", true);
+        size_t bytes = prefs.getBytes("state", &state, sizeof(state));
+        prefs.end();
+
+        if (bytes != sizeof(state) || state.magic != ENERGY_STATE_MAGIC ||
+            !bucketQueueValid(state.closedHours) || !bucketQueueValid(state.closedDays))
+        {
+            memset(&state, 0, sizeof(state));
+            state.magic = ENERGY_STATE_MAGIC;
+            state.hour = -1;
+        }
+    }
+    lastUpdate = millis();
+    lastSave = millis();
+}
+
+/**************************************
+ *   Integrate heater energy          *
+ *           start                    *
+ *************************************/
+// Call every loop pass with the commanded relay state and the latest
+// heater current. Energy is current x MAINS_VOLTAGE over relay-on time.
+void updateEnergyMeter(bool relayOn, double current)
+{
+    unsigned long now = millis();
+    uint32_t dt = now - lastUpdate;
+    lastUpdate = now;
+
+    float wattHours = relayOn ? current * MAINS_VOLTAGE * dt / 3600000.0f : 0.0f;
+    EnergyBucket *buckets[2] = {&state.hourBucket, &state.dayBucket};
+    for (EnergyBucket *bucket : buckets)
+    {
+        bucket->wattHours += wattHours;
+        bucket->elapsedMs += dt;
+        if (relayOn)
+        {
+            bucket->onMs += dt;
+        }
+    }
+
+    // Bucket boundaries follow the local wall clock once NTP has set it
+    uint32_t dayKey;
+    int32_t hour;
+    if (bucketPeriodOf(timeClient.getEpochTime(), dayKey, hour))
+    {
+        if (state.hour < 0)
+        {
+            // First valid clock reading: the open buckets belong to now
+            state.dayKey = dayKey;
+            state.hour = hour;
+        }
+        else if (hour != state.hour || dayKey != state.dayKey)
+        {
+            bucketQueuePush(state.closedHours, state.dayKey, state.hour, state.hourBucket);
+            memset(&state.hourBucket, 0, sizeof(EnergyBucket));
+            state.hour = hour;
+
+            if (dayKey != state.dayKey)
+            {
+                bucketQueuePush(state.closedDays, state.dayKey, -1, state.dayBucket);
+                memset(&state.dayBucket, 0, sizeof(EnergyBucket));
+                state.dayKey = dayKey;
+            }
+            saveEnergyState();
+        }
+    }
+
+    if (now - lastSave >= ENERGY_SAVE_INTERVAL)
+    {
+        saveEnergyState();
+    }
+
+    if (state.closedHours.count > 0 || state.closedDays.count > 0)
+    {
+        publishPendingRollups();
+    }
+}
+/**************************************
+ *   Integrate heater energy          *
+ *           end                      *
+ *************************************/
+
+const EnergyBucket &getHourEnergy()
+{
+    return state.hourBucket;
+}
+
+const EnergyBucket &getDayEnergy()
+{
+    return state.dayBucket;
+}
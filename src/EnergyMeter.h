@@ -0,0 +1,24 @@
+// ==================================================
+// File: src/EnergyMeter.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+#define ENERGY_SAVE_INTERVAL 900000 // ms between NVS checkpoints inside an hour
+
+// Energy and relay-on time accumulated over one period
+struct EnergyBucket
+{
+    float wattHours;
+    uint32_t onMs;      // Relay-on time
+    uint32_t elapsedMs; // Time covered by the bucket
+};
+
+// Function declarations
+void initEnergyMeter();
+void updateEnergyMeter(bool relayOn, double current);
+const EnergyBucket &getHourEnergy();
+const EnergyBucket &getDayEnergy();
+float energyDutyPercent(const EnergyBucket &bucket);
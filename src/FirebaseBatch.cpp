@@ -0,0 +1,179 @@
+// ==================================================
+// File: src/FirebaseBatch.cpp
+// ==================================================
+
+#include "FirebaseBatch.h"
+#include "FirebaseService.h"
+#include "Config.h"
+
+struct BatchEntry
+{
+    char path[FIREBASE_BATCH_PATH_LEN];
+    char value[FIREBASE_BATCH_VALUE_LEN]; // Already JSON: 21.50, -67 or "Good"
+    bool dirty;
+};
+
+static BatchEntry entries[FIREBASE_BATCH_MAX_PATHS];
+static int entryCount = 0;
+static FirebaseBatchStats stats = {};
+
+// Paths keep their slot once used, so a steady set of publishers never
+// fills the table
+static void queueJsonValue(const char *path, const char *json)
+{
+    for (int i = 0; i < entryCount; i++)
+    {
+        if (strcmp(entries[i].path, path) == 0)
+        {
+            if (entries[i].dirty)
+            {
+                stats.coalesced++;
+            }
+            strncpy(entries[i].value, json, sizeof(entries[i].value) - 1);
+            entries[i].dirty = true;
+            return;
+        }
+    }
+    if (entryCount >= FIREBASE_BATCH_MAX_PATHS || strlen(path) >= FIREBASE_BATCH_PATH_LEN)
+    {
+        stats.dropped++;
+        return;
+    }
+    BatchEntry &entry = entries[entryCount++];
+    strncpy(entry.path, path, sizeof(entry.path) - 1);
+    strncpy(entry.value, json, sizeof(entry.value) - 1);
+    entry.dirty = true;
+}
+
+void queueFirebaseValue(const char *path, float value)
+{
+    char json[FIREBASE_BATCH_VALUE_LEN];
+    snprintf(json, sizeof(json), "%.2f", value);
+    queueJsonValue(path, json);
+}
+
+void queueFirebaseValue(const char *path, long value)
+{
+    char json[FIREBASE_BATCH_VALUE_LEN];
+    snprintf(json, sizeof(json), "%ld", value);
+    queueJsonValue(path, json);
+}
+
+void queueFirebaseValue(const char *path, const char *value)
+{
+    char json[FIREBASE_BATCH_VALUE_LEN];
+    size_t used = 0;
+    json[used++] = '"';
+    for (const char *c = value; *c && used < sizeof(json) - 3; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            continue; // Status strings never need them
+        }
+        json[used++] = *c;
+    }
+    json[used++] = '"';
+    json[used] = '\0';
+    queueJsonValue(path, json);
+}
+
+/**************************************
+ *   Multi-path flush                 *
+ *           start                    *
+ *************************************/
+// {"sensors/tempRed":21.50,"wifi/rssi":-67,...} PATCHed at
+// FIREBASE_BATCH_ROOT: each key replaces only its own leaf. Entries that do
+// not fit in the payload stay dirty for the next flush.
+bool flushFirebaseBatch()
+{
+    if (!fbInitialized)
+    {
+        return false;
+    }
+
+    static char payload[FIREBASE_BATCH_PAYLOAD_LEN];
+    bool included[FIREBASE_BATCH_MAX_PATHS] = {};
+    size_t used = 0;
+    int paths = 0;
+    payload[used++] = '{';
+    for (int i = 0; i < entryCount; i++)
+    {
+        if (!entries[i].dirty)
+        {
+            continue;
+        }
+        int length = snprintf(payload + used, sizeof(payload) - used, "%s\"%s\":%s",
+                              paths ? "," : "", entries[i].path, entries[i].value);
+        if (length < 0 || used + length >= sizeof(payload) - 1)
+        {
+            payload[used] = '\0';
+            break;
+        }
+        used += length;
+        included[i] = true;
+        paths++;
+    }
+    if (paths == 0)
+    {
+        return true;
+    }
+    payload[used++] = '}';
+    payload[used] = '\0';
+
+    FirebaseJson json;
+    json.setJsonData(payload);
+    unsigned long start = millis();
+    bool ok = Firebase.RTDB.updateNode(&fbData, FIREBASE_BATCH_ROOT, &json);
+    uint32_t latency = millis() - start;
+
+    stats.lastLatencyMs = latency;
+    if (latency > stats.maxLatencyMs)
+    {
+        stats.maxLatencyMs = latency;
+    }
+    stats.lastPayloadBytes = used;
+    if (used > stats.maxPayloadBytes)
+    {
+        stats.maxPayloadBytes = used;
+    }
+    if (!ok)
+    {
+        stats.failures++;
+#if DEBUG_SERIAL
+        Serial.print("Firebase batch update failed: ");
+        Serial.println(fbData.errorReason());
+#endif
+        return false;
+    }
+
+    stats.flushes++;
+    stats.pathsSent += paths;
+    for (int i = 0; i < entryCount; i++)
+    {
+        if (included[i])
+        {
+            entries[i].dirty = false;
+        }
+    }
+    return true;
+}
+/**************************************
+ *   Multi-path flush                 *
+ *           end                      *
+ *************************************/
+
+void flushFirebaseBatchIfDue()
+{
+    static unsigned long lastFlush = 0;
+    if (millis() - lastFlush < FIREBASE_SYNC_INTERVAL)
+    {
+        return;
+    }
+    lastFlush = millis();
+    flushFirebaseBatch();
+}
+
+FirebaseBatchStats getFirebaseBatchStats()
+{
+    return stats;
+}
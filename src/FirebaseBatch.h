@@ -0,0 +1,38 @@
+// ==================================================
+// File: src/FirebaseBatch.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+
+// Write coalescing for ESP32/control. Publishers mark paths dirty with
+// queueFirebaseValue(); flushFirebaseBatch() sends every dirty path as one
+// multi-path updateNode (a single HTTPS PATCH) instead of one blocking
+// set* round trip per value. A path queued twice before a flush is sent
+// once, with the latest value.
+#define FIREBASE_BATCH_ROOT "ESP32/control"
+#define FIREBASE_BATCH_MAX_PATHS 24
+#define FIREBASE_BATCH_PATH_LEN 40  // Relative to FIREBASE_BATCH_ROOT
+#define FIREBASE_BATCH_VALUE_LEN 32 // Formatted JSON value
+#define FIREBASE_BATCH_PAYLOAD_LEN 2048
+
+struct FirebaseBatchStats
+{
+    uint32_t flushes;       // Successful updateNode calls
+    uint32_t failures;      // Failed updateNode calls; their paths stay dirty
+    uint32_t pathsSent;
+    uint32_t coalesced;     // Writes absorbed by a later write to the same path
+    uint32_t dropped;       // Writes refused because the table was full
+    uint32_t lastLatencyMs;
+    uint32_t maxLatencyMs;
+    uint32_t lastPayloadBytes;
+    uint32_t maxPayloadBytes;
+};
+
+// Function declarations
+void queueFirebaseValue(const char *path, float value);
+void queueFirebaseValue(const char *path, long value);
+void queueFirebaseValue(const char *path, const char *value);
+bool flushFirebaseBatch();      // true if nothing was pending or the PATCH succeeded
+void flushFirebaseBatchIfDue(); // loop(); flushes every FIREBASE_SYNC_INTERVAL
+FirebaseBatchStats getFirebaseBatchStats();
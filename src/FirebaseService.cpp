@@ -9,6 +9,9 @@
 #include <time.h>
 #include "TemperatureSensors.h"
 #include "GetSchedule.h"
+#include "ReportByException.h"
+#include "FirebaseBatch.h"
+#include "HistoryOutbox.h"
 #include "MQTTManager.h" // For MQTT client access
 #include "TimeManager.h" // For time formatting functions
 #include "StatusLEDs.h"  // For LED status updates
@@ -200,15 +203,15 @@ void handleFirebase(SystemStatus &status)
 }
 void pushTargetTempToFirebase(float targetTemp)
 {
-    if (!fbInitialized)
+    if (!fbInitialized || !shouldReport(REPORT_TARGET_FIREBASE, targetTemp))
     {
         return;
     }
-    Firebase.RTDB.setFloat(&fbData, "ESP32/control/target_temperature", targetTemp);
+    queueFirebaseValue("target_temperature", targetTemp);
 }
 
 /**
- * Push current sensor readings to Firebase Realtime Database
+ * Queue current sensor readings for the next Firebase batch flush
  * This allows the dashboard to fetch initial values on load
  */
 void pushSensorDataToFirebase(float tempRed, float tempBlue, float tempGreen)
@@ -218,39 +221,23 @@ void pushSensorDataToFirebase(float tempRed, float tempBlue, float tempGreen)
         return;
     }
 
-    // Push red sensor data
-    if (!isnan(tempRed))
-    {
-        Firebase.RTDB.setFloat(&fbData, "ESP32/control/sensors/tempRed", tempRed);
-    }
-    else
-    {
-        Firebase.RTDB.setString(&fbData, "ESP32/control/sensors/tempRed", "ERROR");
-    }
-
-    // Push blue sensor data
-    if (!isnan(tempBlue))
-    {
-        Firebase.RTDB.setFloat(&fbData, "ESP32/control/sensors/tempBlue", tempBlue);
-    }
-    else
-    {
-        Firebase.RTDB.setString(&fbData, "ESP32/control/sensors/tempBlue", "ERROR");
-    }
-
-    // Push green sensor data
-    if (!isnan(tempGreen))
-    {
-        Firebase.RTDB.setFloat(&fbData, "ESP32/control/sensors/tempGreen", tempGreen);
-    }
-    else
+    const char *paths[3] = {"sensors/tempRed", "sensors/tempBlue", "sensors/tempGreen"};
+    const float temps[3] = {tempRed, tempBlue, tempGreen};
+    for (int i = 0; i < 3; i++)
     {
-        Firebase.RTDB.setString(&fbData, "ESP32/control/sensors/tempGreen", "ERROR");
+        if (!isnan(temps[i]))
+        {
+            queueFirebaseValue(paths[i], temps[i]);
+        }
+        else
+        {
+            queueFirebaseValue(paths[i], "ERROR");
+        }
     }
 
     // Store timestamp for when data was last updated
     String timestamp = getFormattedTime();
-    Firebase.RTDB.setString(&fbData, "ESP32/control/sensors/lastUpdated", timestamp);
+    queueFirebaseValue("sensors/lastUpdated", timestamp.c_str());
 }
 
 // New function: Store sensor data with timestamp for historical charts
@@ -376,66 +363,41 @@ void pushSensorDataToFirebaseHistory(float tempRed, float tempBlue, float tempGr
     }
 }
 
-// Function to periodically store historical data (call this every 5 minutes)
-void storeHistoricalDataIfNeeded(float tempRed, float tempBlue, float tempGreen)
+// Appends a history sample every 10 minutes. Called from loop() on its own
+// timer, so samples keep being taken while MQTT or Firebase is down and
+// whether or not the temperatures changed.
+// Retention of old days is handled by HistoryRetention
+void storeHistoricalDataIfDue()
 {
+#if HISTORY_BLOCK_MODE
+    return; // Hourly blocks carry the history (see HistoryBlocks)
+#endif
     static unsigned long lastHistoricalStore = 0;
-    static unsigned long lastCleanup = 0;
-    const unsigned long HISTORICAL_INTERVAL = 600000; // 10 minutes for testing (change back to 300000 for 5 minutes)
-    const unsigned long CLEANUP_INTERVAL = 604800000; // 7 days in milliseconds (weekly cleanup)
+    const unsigned long HISTORICAL_INTERVAL = 600000; // 10 minutes
 
     unsigned long now = millis();
-
-    // Store historical data every 5 minutes
-    if (now - lastHistoricalStore >= HISTORICAL_INTERVAL)
-    {
-        pushSensorDataToFirebaseHistory(tempRed, tempBlue, tempGreen);
-        lastHistoricalStore = now;
-    }
-    else
-    {
-        unsigned long remainingTime = HISTORICAL_INTERVAL - (now - lastHistoricalStore);
-    }
-
-    // Clean up old data once per week (removes data older than 3 months)
-    if (now - lastCleanup >= CLEANUP_INTERVAL)
-    {
-        cleanupOldHistoricalData();
-        lastCleanup = now;
-    }
-}
-
-// Cleanup function (removes data older than 3 months = 90 days)
-void cleanupOldHistoricalData()
-{
-    if (!fbInitialized)
+    if (now - lastHistoricalStore < HISTORICAL_INTERVAL)
     {
         return;
     }
-    time_t now = time(nullptr);
-    if (now < 1000000000)
+    lastHistoricalStore = now;
+
+    // Samples go through the outbox so an outage delays them instead of
+    // losing them; without NTP time or a filesystem they are written
+    // directly as before.
+    float tempRed = getTemperature(PROBE_ROLE_RED);
+    float tempBlue = getTemperature(PROBE_ROLE_BLUE);
+    float tempGreen = getTemperature(PROBE_ROLE_GREEN);
+    time_t utc = 0;
+    getUtcEpoch(utc);
+    if (!appendHistoryRecord(utc, tempRed, tempBlue, tempGreen))
     {
-        return;
+        pushSensorDataToFirebaseHistory(tempRed, tempBlue, tempGreen);
     }
-
-    // Calculate cutoff date (90 days ago for 3-month retention)
-    time_t cutoff = now - (90 * 24 * 60 * 60);
-    struct tm *cutoffInfo = gmtime(&cutoff);
-    char cutoffDate[16];
-    strftime(cutoffDate, sizeof(cutoffDate), "%Y-%m-%d", cutoffInfo);
-
-    // For the daily structure ESP32/history/daily/YYYY-MM-DD/
-    // we would need to:
-    // 1. Query all date folders under ESP32/history/daily/
-    // 2. Compare each YYYY-MM-DD with cutoffDate
-    // 3. Delete entire daily folders older than 90 days
-
-    // This is more efficient than the old structure since we can
-    // delete entire days at once rather than individual entries
 }
 
 /**
- * Push WiFi RSSI values to Firebase Realtime Database
+ * Queue WiFi RSSI values for the next Firebase batch flush
  * Includes signal strength classification for dashboard
  */
 void pushRSSIToFirebase(long rssi)
@@ -446,7 +408,7 @@ void pushRSSIToFirebase(long rssi)
     }
 
     // Push raw RSSI value
-    Firebase.RTDB.setInt(&fbData, "ESP32/control/wifi/rssi", rssi);
+    queueFirebaseValue("wifi/rssi", rssi);
 
     // Classify signal strength and push as string for easy dashboard display
     String signalQuality;
@@ -471,9 +433,9 @@ void pushRSSIToFirebase(long rssi)
         signalQuality = "Very Low";
     }
 
-    Firebase.RTDB.setString(&fbData, "ESP32/control/wifi/signalQuality", signalQuality);
+    queueFirebaseValue("wifi/signalQuality", signalQuality.c_str());
 
     // Store timestamp for when RSSI was last updated
     String timestamp = getFormattedTime();
-    Firebase.RTDB.setString(&fbData, "ESP32/control/wifi/lastUpdated", timestamp);
+    queueFirebaseValue("wifi/lastUpdated", timestamp.c_str());
 }
@@ -20,8 +20,7 @@ void fetchScheduleDataFromFirebase();
 void publishFirebaseStatus(const char *status);
 void pushSensorDataToFirebase(float tempRed, float tempBlue, float tempGreen);
 void pushSensorDataToFirebaseHistory(float tempRed, float tempBlue, float tempGreen);
-void storeHistoricalDataIfNeeded(float tempRed, float tempBlue, float tempGreen);
-void cleanupOldHistoricalData();
+void storeHistoricalDataIfDue(); // loop(); one history sample every 10 minutes
 void pushRSSIToFirebase(long rssi);
 // In FirebaseService.h
 // void pushTimeToFirebase(const String& amTime, const String& pmTime);
@@ -6,6 +6,7 @@
 #include "FirebaseService.h"
 #include "HeaterControl.h"
 #include "Globals.h"
+#include "ScheduleEngine.h"
 // #include <Firebase_ESP_Client.h>
 
 // Global schedule data instance - no default values
@@ -106,21 +107,12 @@ void fetchScheduleDataFromFirebase()
         allDataRetrieved = false;
     }
 
-    if (allDataRetrieved)
+    if (!allDataRetrieved)
     {
-        // Refresh the heater control cache with the new Firebase data
-        refreshScheduleCache();
-    }
-    getTime(); // Ensure time is fetched to parse schedule times correctly
-
-    if (Hours >= 12)
-    {
-        targetTemp = currentSchedule.pmTemp;
-    }
-    else
-    {
-        targetTemp = currentSchedule.amTemp;
+        Serial.println("Schedule fetch incomplete - using the values that were retrieved");
     }
+    // Rebuild the setpoint table; the next control pass picks the active one
+    refreshScheduleCache();
 }
 //=======================================================
 // I only want to fetch the schedule data once on startup
@@ -312,6 +304,7 @@ void setAMTemperature(float temp)
     if (isValidTemperature(temp))
     {
         currentSchedule.amTemp = temp;
+        refreshScheduleCache();
     }
 }
 
@@ -320,6 +313,7 @@ void setPMTemperature(float temp)
     if (isValidTemperature(temp))
     {
         currentSchedule.pmTemp = temp;
+        refreshScheduleCache();
     }
 }
 
@@ -328,6 +322,7 @@ void setAMTime(const String &time)
     if (isValidTime(time))
     {
         currentSchedule.amTime = time;
+        refreshScheduleCache();
     }
 }
 
@@ -336,34 +331,19 @@ void setPMTime(const String &time)
     if (isValidTime(time))
     {
         currentSchedule.pmTime = time;
+        refreshScheduleCache();
     }
 }
 
 float getCurrentScheduledTemperature()
 {
-    // Get current time to determine if we should use AM or PM temperature
-    if (AmFlag)
+    // Setpoint active now, from the schedule engine
+    Setpoint active;
+    if (timeClient.isTimeSet() && getActiveSetpoint(timeClient.getEpochTime(), active))
     {
-        if (!isnan(currentSchedule.amTemp))
-        {
-            return currentSchedule.amTemp;
-        }
-        else
-        {
-            return NAN;
-        }
-    }
-    else
-    {
-        if (!isnan(currentSchedule.pmTemp))
-        {
-            return currentSchedule.pmTemp;
-        }
-        else
-        {
-            return NAN;
-        }
+        return active.temperature;
     }
+    return NAN;
 }
 
 String formatTime(int hours, int minutes)
@@ -0,0 +1,97 @@
+// ==================================================
+// File: src/HeaterBands.h
+// ==================================================
+// Threshold table that maps heater current to a HeaterState. Plain C++
+// with no Arduino dependencies, so every transition can be checked on a
+// host (test/test_classifier).
+
+#pragma once
+#include <stdint.h>
+#include "HeaterState.h"
+
+#define HEATER_MAX_BANDS 6
+
+// Current range mapped to a heater state. A state is left only once the
+// current is more than `hysteresis` outside [lower, upper).
+struct HeaterBand
+{
+    HeaterState state;
+    float lower; // A, inclusive
+    float upper; // A, exclusive
+    float hysteresis;
+};
+
+// Everything that used to be compile-time: bands plus the CT calibration
+struct HeaterClassifierTable
+{
+    uint8_t bandCount;
+    HeaterBand bands[HEATER_MAX_BANDS]; // Ascending by lower
+    float calibration;                  // Amps per volt of the CT burden (EmonLib ICAL)
+};
+
+// Defaults for 2x100 W heaters, matching the old hard-coded breakpoints
+inline HeaterClassifierTable defaultHeaterTable(float calibration)
+{
+    HeaterClassifierTable t = {
+        3,
+        {
+            {BOTH_HEATERS_BLOWN, 0.0, 1.5, 0.2},
+            {ONE_HEATER_ON, 1.5, 2.8, 0.2},
+            {BOTH_HEATERS_ON, 2.8, 1000.0, 0.2},
+        },
+        calibration};
+    return t;
+}
+
+// Bands ascending, non-empty and with a usable calibration
+inline bool isValidHeaterTable(const HeaterClassifierTable &t)
+{
+    if (t.bandCount == 0 || t.bandCount > HEATER_MAX_BANDS || !(t.calibration > 0))
+    {
+        return false;
+    }
+    for (int i = 0; i < t.bandCount; i++)
+    {
+        const HeaterBand &band = t.bands[i];
+        if (!(band.lower < band.upper) || band.hysteresis < 0)
+        {
+            return false;
+        }
+        if (i > 0 && band.lower < t.bands[i - 1].lower)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Pure function of the table, the previous state and the current. The
+// previous state is kept while the current stays within its band widened
+// by the band's hysteresis; otherwise the band containing the current wins.
+inline HeaterState classifyHeaterCurrent(const HeaterClassifierTable &t, HeaterState lastState, double current)
+{
+    HeaterState rawState = t.bands[0].state; // Below the table: lowest band
+    for (int i = 0; i < t.bandCount; i++)
+    {
+        if (current >= t.bands[i].lower)
+        {
+            rawState = t.bands[i].state;
+        }
+    }
+
+    if (rawState == lastState)
+    {
+        return lastState;
+    }
+    for (int i = 0; i < t.bandCount; i++)
+    {
+        const HeaterBand &band = t.bands[i];
+        if (band.state == lastState &&
+            current >= band.lower - band.hysteresis &&
+            current < band.upper + band.hysteresis)
+        {
+            return lastState; // Still inside the deadband of the old state
+        }
+    }
+    return rawState;
+}
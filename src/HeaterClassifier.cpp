@@ -0,0 +1,239 @@
+// ==================================================
+// File: src/HeaterClassifier.cpp
+// ==================================================
+// Maps heater current to a HeaterState through a threshold table that is
+// stored in NVS and can be replaced over MQTT, and learns the zero-current
+// baseline while the relay is off.
+
+#include "HeaterClassifier.h"
+#include <Preferences.h>
+#include <ArduinoJson.h>
+#include "CurrentSampler.h"
+
+static HeaterClassifierTable table = defaultHeaterTable(CALIBRATION_CONSTANT);
+
+// Learned zero-current offset for each CurrentAnalysisMode
+static const double defaultBaseline[2] = {BASELINE_OFFSET, SPECTRAL_BASELINE_OFFSET};
+static double baseline[2] = {BASELINE_OFFSET, SPECTRAL_BASELINE_OFFSET};
+static double savedBaseline[2] = {BASELINE_OFFSET, SPECTRAL_BASELINE_OFFSET};
+
+// The table and baseline are changed from loop() and read by the control
+// task; doubles are not written atomically, so both go through this lock
+static portMUX_TYPE classifierLock = portMUX_INITIALIZER_UNLOCKED;
+
+static void saveTable()
+{
+    Preferences prefs;
+    prefs.begin("heatercls", false);
+    prefs.putBytes("table", &table, sizeof(table));
+    prefs.end();
+}
+
+static void saveBaseline()
+{
+    Preferences prefs;
+    prefs.begin("heatercls", false);
+    prefs.putBytes("baseline", baseline, sizeof(baseline));
+    prefs.end();
+    savedBaseline[0] = baseline[0];
+    savedBaseline[1] = baseline[1];
+}
+
+void initHeaterClassifier()
+{
+    HeaterClassifierTable stored;
+    double storedBaseline[2];
+    Preferences prefs;
+    prefs.begin("heatercls", true);
+    size_t tableBytes = prefs.getBytes("table", &stored, sizeof(stored));
+    size_t baselineBytes = prefs.getBytes("baseline", storedBaseline, sizeof(storedBaseline));
+    prefs.end();
+
+    if (tableBytes == sizeof(stored) && isValidHeaterTable(stored))
+    {
+        table = stored;
+    }
+    if (baselineBytes == sizeof(storedBaseline))
+    {
+        for (int m = 0; m < 2; m++)
+        {
+            if (storedBaseline[m] >= 0 && storedBaseline[m] <= defaultBaseline[m] + BASELINE_MAX_DRIFT)
+            {
+                baseline[m] = savedBaseline[m] = storedBaseline[m];
+            }
+        }
+    }
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    setCurrentCalibration(table.calibration);
+#endif
+}
+
+HeaterState getHeaterState(double current)
+{
+    static HeaterState lastState = BOTH_HEATERS_ON; // Remember last state
+    HeaterClassifierTable activeTable = getHeaterClassifierTable();
+    lastState = classifyHeaterCurrent(activeTable, lastState, current);
+
+#if DEBUG_SERIAL
+    Serial.print("Current: ");
+    Serial.print(current, 2);
+    Serial.print("A, State: ");
+    Serial.println(heaterStateToString(lastState));
+#endif
+
+    return lastState;
+}
+
+HeaterClassifierTable getHeaterClassifierTable()
+{
+    portENTER_CRITICAL(&classifierLock);
+    HeaterClassifierTable copy = table;
+    portEXIT_CRITICAL(&classifierLock);
+    return copy;
+}
+
+// Accepts e.g.
+// {"bands":[{"state":"BOTH_HEATERS_BLOWN","lo":0,"hi":1.5,"hyst":0.2},
+//           {"state":"ONE_HEATER_ON","lo":1.5,"hi":2.8,"hyst":0.2},
+//           {"state":"BOTH_HEATERS_ON","lo":2.8,"hi":1000,"hyst":0.2}],
+//  "cal":68.3}
+// Either key may be omitted. The result is validated before it is used and saved.
+bool setHeaterClassifierFromJson(const String &json)
+{
+    JsonDocument doc;
+    if (deserializeJson(doc, json))
+    {
+        return false;
+    }
+
+    HeaterClassifierTable updated = table;
+    JsonArray bands = doc["bands"].as<JsonArray>();
+    if (!bands.isNull())
+    {
+        updated.bandCount = 0;
+        for (JsonObject band : bands)
+        {
+            if (updated.bandCount >= HEATER_MAX_BANDS)
+            {
+                return false;
+            }
+            const char *name = band["state"] | "";
+            bool known = false;
+            for (int s = HEATER_STARTUP; s <= BOTH_HEATERS_BLOWN; s++)
+            {
+                if (strcmp(name, heaterStateToString((HeaterState)s)) == 0)
+                {
+                    updated.bands[updated.bandCount].state = (HeaterState)s;
+                    known = true;
+                }
+            }
+            if (!known)
+            {
+                return false;
+            }
+            updated.bands[updated.bandCount].lower = band["lo"] | -1.0f;
+            updated.bands[updated.bandCount].upper = band["hi"] | -1.0f;
+            updated.bands[updated.bandCount].hysteresis = band["hyst"] | 0.0f;
+            updated.bandCount++;
+        }
+    }
+    updated.calibration = doc["cal"] | updated.calibration;
+
+    if (!isValidHeaterTable(updated))
+    {
+        return false;
+    }
+    portENTER_CRITICAL(&classifierLock);
+    table = updated;
+    portEXIT_CRITICAL(&classifierLock);
+    saveTable();
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    setCurrentCalibration(updated.calibration);
+#endif
+    return true;
+}
+
+double getCurrentBaseline()
+{
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    return getCurrentBaseline(getCurrentAnalysisMode());
+#else
+    return getCurrentBaseline(CURRENT_MODE_BROADBAND);
+#endif
+}
+
+double getCurrentBaseline(CurrentAnalysisMode mode)
+{
+    portENTER_CRITICAL(&classifierLock);
+    double value = baseline[mode];
+    portEXIT_CRITICAL(&classifierLock);
+    return value;
+}
+
+/**************************************
+ *   Self-calibrating baseline        *
+ *           start                    *
+ *************************************/
+// Call every loop pass. Once the relay has been off for BASELINE_SETTLE_MS,
+// every new sampler window nudges the baseline toward what the CT reads with
+// no load. The caller stops learning while the relay monitor sees more than
+// BASELINE_MAX_RISE, and readings more than BASELINE_MAX_DRIFT above the
+// default are skipped, so a welded relay or a slowly growing leak cannot be
+// absorbed as offset and hidden from the relay monitor.
+void learnCurrentBaseline(bool relayOff)
+{
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    static unsigned long offSince = 0;
+    static bool wasOff = false;
+    static uint32_t lastWindow = 0;
+    static unsigned long lastSave = 0;
+
+    unsigned long now = millis();
+    if (!relayOff)
+    {
+        wasOff = false;
+        return;
+    }
+    if (!wasOff)
+    {
+        wasOff = true;
+        offSince = now;
+    }
+    uint32_t window = getCurrentWindowCount();
+    if (now - offSince < BASELINE_SETTLE_MS || window == lastWindow)
+    {
+        return;
+    }
+    lastWindow = window;
+
+    CurrentSpectrum spectrum = getCurrentSpectrum();
+    double readings[2] = {spectrum.totalRms, spectrum.fundamentalRms};
+    for (int m = 0; m < 2; m++)
+    {
+        if (readings[m] <= defaultBaseline[m] + BASELINE_MAX_DRIFT)
+        {
+            portENTER_CRITICAL(&classifierLock);
+            baseline[m] += (readings[m] - baseline[m]) * BASELINE_LEARN_RATE;
+            portEXIT_CRITICAL(&classifierLock);
+        }
+    }
+
+    bool drifted = fabs(baseline[0] - savedBaseline[0]) > 0.02 || fabs(baseline[1] - savedBaseline[1]) > 0.02;
+    if (drifted && now - lastSave >= BASELINE_SAVE_INTERVAL)
+    {
+        saveBaseline();
+        lastSave = now;
+#if DEBUG_SERIAL
+        Serial.print("Current baseline saved: ");
+        Serial.print(baseline[0], 3);
+        Serial.print(" A rms, ");
+        Serial.print(baseline[1], 3);
+        Serial.println(" A fundamental");
+#endif
+    }
+#endif
+}
+/**************************************
+ *   Self-calibrating baseline        *
+ *           end                      *
+ *************************************/
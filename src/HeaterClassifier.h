@@ -0,0 +1,23 @@
+// ==================================================
+// File: src/HeaterClassifier.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "CurrentSampler.h"
+#include "HeaterBands.h"
+
+#define BASELINE_SETTLE_MS 5000     // Relay must be off this long before learning
+#define BASELINE_MAX_DRIFT 0.10     // A the learned baseline may rise above its default; below RELAY_LEAKAGE_THRESHOLD
+#define BASELINE_MAX_RISE 0.03      // A of relay-off current above baseline that stops learning; leakage may be building
+#define BASELINE_LEARN_RATE 0.02    // Fraction of each new window mixed into the baseline
+#define BASELINE_SAVE_INTERVAL 3600000 // ms between NVS writes of the learned baseline
+
+// Function declarations
+void initHeaterClassifier();
+HeaterClassifierTable getHeaterClassifierTable();
+bool setHeaterClassifierFromJson(const String &json);
+double getCurrentBaseline();                          // For the active analysis mode
+double getCurrentBaseline(CurrentAnalysisMode mode);
+void learnCurrentBaseline(bool relayOff);
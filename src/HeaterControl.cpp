@@ -1,7 +1,7 @@
 //==============================
 // Target Temperature Management
 //==============================
-float targetTemp = 0; // persistent across calls
+float targetTemp = 0; // Written by the control task; float stores are atomic
 float getTargetTemp()
 {
     return targetTemp;
@@ -11,6 +11,7 @@ float getTargetTemp()
 // Heater Control
 //==============================
 #include <Arduino.h>
+#include <Preferences.h>
 #include "HeaterControl.h"
 #include "TemperatureSensors.h"
 #include "GetSchedule.h"
@@ -21,106 +22,364 @@ float getTargetTemp()
 #include "FirebaseService.h"
 #include "Config.h"
 #include "Globals.h"
-#include "Send_E-Mail.h"
+#include "AlertEngine.h"
+#include "SafetySupervisor.h"
+#include "ControlInput.h"
+#include "RelayMonitor.h"
+#include "ScheduleEngine.h"
+#include "PiControl.h"
+#include "ControlTask.h"
+#include "ThermalPredictor.h"
+#include "ReportByException.h"
 
 // External declarations
 bool AmFlag = false;
-bool SINGLE_HEATER_OFF = false;
 
-// Global flag to force schedule cache refresh
-static bool forceScheduleRefresh = false;
+static volatile bool relayCommandedOn = false; // setup() drives the relay OFF; read from loop()
 
-// Multi-heater failure detection state variables
-static bool first_Run_Single_Failure = true;
-static bool first_Run_Single_Heater_Alert = true; // Separate flag for 1.91A case
-static bool first_Run_Total_Failure = true;
-static unsigned long last_Single_Failure_Email = 0;
-static unsigned long last_Single_Heater_Alert_Email = 0; // Separate timer for 1.91A case
-static unsigned long last_Total_Failure_Email = 0;
-static HeaterState lastKnownState = BOTH_HEATERS_ON; // Assume both working initially
+// Relay is active-low; tracked in software because reading back an
+// output pin is not reliable on the ESP32
+void setRelay(bool on)
+{
+    if (on && isSafetyTripped())
+    {
+        on = false; // The safety cutout overrides every caller
+    }
+    digitalWrite(RELAY_PIN, on ? LOW : HIGH); // LOW = Relay ON
+    if (on != relayCommandedOn)
+    {
+        relayCommandedOn = on;
+        noteRelaySwitched(on);
+    }
+}
 
-// Forward declaration
-void check_E_Mail_Timers(double currentReading, unsigned long currentMillis);
+bool isRelayCommandedOn()
+{
+    return relayCommandedOn;
+}
 
-// Heater control function
-void updateHeaterControl(SystemStatus &status)
+// Control mode and PI state
+static HeaterControlMode controlMode = CONTROL_MODE_HYSTERESIS;
+static PiController pi = {PI_DEFAULT_KP, (float)(PI_DEFAULT_KP / PI_DEFAULT_INTEGRAL_TIME), 0.0f};
+static TimeProportioner proportioner = {PI_WINDOW_MS, PI_MIN_ON_MS, PI_MIN_OFF_MS, 0, 0, false};
+static float heaterDuty = 0;
+static unsigned long lastPiUpdate = 0;
+static float piIntegralTime = PI_DEFAULT_INTEGRAL_TIME;
+
+// What is in NVS, so loop() only writes when something changed
+static volatile bool controlSettingsDirty = false; // Mode or tuning changed by the control task
+static float savedTarget = 0;
+static float savedIntegral = 0;
+
+/**************************************
+ *   Persisted control state          *
+ *           start                    *
+ *************************************/
+// Restores the target, mode and PI state saved before the last reset, so
+// control is meaningful before WiFi, NTP or Firebase are up. Call in
+// setup() before initControlTask().
+void initHeaterControl()
 {
-    getTime();                               // Updates Hours and Minutes
-    String currentTime = getFormattedTime(); // Returns "HH:MM"
-    
-    if (currentTime < "12:00")
+    Preferences prefs;
+    prefs.begin("control", true);
+    float target = prefs.getFloat("target", 0);
+    uint8_t mode = prefs.getUChar("mode", CONTROL_MODE_HYSTERESIS);
+    float kp = prefs.getFloat("kp", PI_DEFAULT_KP);
+    float integralTime = prefs.getFloat("ti", PI_DEFAULT_INTEGRAL_TIME);
+    float integral = prefs.getFloat("integral", 0);
+    prefs.end();
+
+    targetTemp = isValidTemperature(target) ? target : 0;
+    controlMode = (mode <= CONTROL_MODE_PI) ? (HeaterControlMode)mode : CONTROL_MODE_HYSTERESIS;
+    setPiTuning(kp, integralTime);
+    pi.integral = piClamp(integral, 0.0f, 1.0f);
+
+    savedTarget = targetTemp;
+    savedIntegral = pi.integral;
+    controlSettingsDirty = false;
+
+    Serial.print("Control state restored: target ");
+    Serial.print(targetTemp);
+    Serial.print("°C, mode ");
+    Serial.println(heaterControlModeToString(controlMode));
+}
+
+// loop() side; the target changes at most at each setpoint, and the PI
+// integral is only checkpointed every CONTROL_STATE_SAVE_INTERVAL
+static void saveControlStateIfChanged()
+{
+    static unsigned long lastIntegralSave = 0;
+    float target = targetTemp;
+    float integral = pi.integral;
+    bool saveTarget = (target != savedTarget);
+    bool saveSettings = controlSettingsDirty;
+    bool saveIntegral = controlMode == CONTROL_MODE_PI && fabs(integral - savedIntegral) > 0.02 &&
+                        millis() - lastIntegralSave >= CONTROL_STATE_SAVE_INTERVAL;
+    if (!saveTarget && !saveSettings && !saveIntegral)
     {
-        AmFlag = true;
+        return;
     }
-    else
+
+    Preferences prefs;
+    prefs.begin("control", false);
+    if (saveTarget)
+    {
+        prefs.putFloat("target", target);
+        savedTarget = target;
+    }
+    if (saveSettings)
+    {
+        controlSettingsDirty = false;
+        prefs.putUChar("mode", controlMode);
+        prefs.putFloat("kp", pi.kp);
+        prefs.putFloat("ti", piIntegralTime);
+    }
+    if (saveIntegral)
+    {
+        prefs.putFloat("integral", integral);
+        savedIntegral = integral;
+        lastIntegralSave = millis();
+    }
+    prefs.end();
+}
+/**************************************
+ *   Persisted control state          *
+ *           end                      *
+ *************************************/
+
+// Relay decision for one pass
+void setHeaterControlMode(HeaterControlMode mode)
+{
+    if (mode != controlMode)
+    {
+        // Start the PI bumpless from where the relay is now
+        pi.integral = relayCommandedOn ? 0.5f : 0.0f;
+        tpInit(proportioner, PI_WINDOW_MS, PI_MIN_ON_MS, PI_MIN_OFF_MS);
+        lastPiUpdate = 0;
+        controlMode = mode;
+        controlSettingsDirty = true;
+#if DEBUG_SERIAL
+        Serial.print("Heater control mode: ");
+        Serial.println(heaterControlModeToString(mode));
+#endif
+    }
+}
+
+HeaterControlMode getHeaterControlMode()
+{
+    return controlMode;
+}
+
+const char *heaterControlModeToString(HeaterControlMode mode)
+{
+    switch (mode)
+    {
+    case CONTROL_MODE_HYSTERESIS: return "hysteresis";
+    case CONTROL_MODE_PI:         return "pi";
+    default:                      return "unknown";
+    }
+}
+
+bool parseHeaterControlMode(const String &text, HeaterControlMode &mode)
+{
+    if (text == "hysteresis")
+    {
+        mode = CONTROL_MODE_HYSTERESIS;
+        return true;
+    }
+    if (text == "pi")
+    {
+        mode = CONTROL_MODE_PI;
+        return true;
+    }
+    return false;
+}
+
+void setPiTuning(float kp, float integralTimeS)
+{
+    if (kp > 0 && integralTimeS >= 0)
     {
-        AmFlag = false;
+        float integral = pi.integral;
+        piInit(pi, kp, integralTimeS);
+        pi.integral = integral;
+        piIntegralTime = integralTimeS;
+        controlSettingsDirty = true;
     }
-    
-    readAllSensors();
-    float tempRed = getTemperature(0); // Get the value of the Red sensor
+}
 
-    float newTargetTemp = AmFlag ? currentSchedule.amTemp : currentSchedule.pmTemp;
-    String scheduledTime = AmFlag ? currentSchedule.amTime : currentSchedule.pmTime;
+float getHeaterDuty()
+{
+    return heaterDuty;
+}
+
+// PI duty, then the time-proportioning window decides on or off
+static HeaterDemand piDemand(float controlTemp, float target)
+{
+    unsigned long now = millis();
+    float dtS = (lastPiUpdate == 0) ? 0.0f : (now - lastPiUpdate) / 1000.0f;
+    lastPiUpdate = now;
+    heaterDuty = piUpdate(pi, target - controlTemp, dtS);
+    return tpUpdate(proportioner, heaterDuty, now) ? DEMAND_ON : DEMAND_OFF;
+}
 
-    if (scheduledTime == currentTime)
+// Result of the latest decision, handed to loop() under controlLock
+struct HeaterControlSnapshot
+{
+    HeaterState heater;
+    bool relayOn;
+    float current; // A, last reading taken while heating
+    RelayFault relayFault;
+};
+static HeaterControlSnapshot controlSnapshot = {HEATERS_OFF, false, 0, RELAY_FAULT_NONE};
+static portMUX_TYPE controlLock = portMUX_INITIALIZER_UNLOCKED;
+
+/**************************************
+ *   Relay decision (control task)    *
+ *           start                    *
+ *************************************/
+// Runs in the control task once per CONTROL_DECISION_TICKS. No network,
+// LED or email calls here: anything loop() has to act on goes out as a
+// ControlEvent or through controlSnapshot.
+void runHeaterControl()
+{
+    static HeaterState heaterState = HEATERS_OFF;
+    static float currentReading = 0;
+
+    // Combine the probes according to the configured policy
+    ControlInput input = evaluateControlInput();
+    float controlTemp = input.temperature;
+
+    // The target is whatever setpoint is active now, so it is right straight
+    // after boot and a pass that misses the transition minute cannot skip it
+    time_t localTime;
+    Setpoint active;
+    if (getControlLocalTime(localTime) && getActiveSetpoint(localTime, active))
     {
-        targetTemp = newTargetTemp;
+        float target = active.temperature;
+
+        // Pre-heat: move to a higher upcoming setpoint once the learned model
+        // says heating has to start now to reach it on time. Latched on that
+        // setpoint so the shrinking lead cannot toggle the target back.
+        static int32_t preheatMinute = -1;
+        Setpoint next;
+        uint32_t secondsUntil;
+        if (getNextSetpoint(localTime, next, secondsUntil) && next.temperature > target)
+        {
+            if (next.minuteOfDay != preheatMinute && input.valid &&
+                getPreheatLeadSeconds(controlTemp, next.temperature) >= secondsUntil)
+            {
+                preheatMinute = next.minuteOfDay;
+#if DEBUG_SERIAL
+                Serial.print("Pre-heating for ");
+                Serial.print(formatTime(next.minuteOfDay / 60, next.minuteOfDay % 60));
+                Serial.print(", ");
+                Serial.print(secondsUntil / 60);
+                Serial.println(" min early");
+#endif
+            }
+            if (next.minuteOfDay == preheatMinute)
+            {
+                target = next.temperature;
+            }
+        }
+        else
+        {
+            preheatMinute = -1;
+        }
+
+        if (target != targetTemp)
+        {
+            targetTemp = target;
 #if DEBUG_SERIAL
-        Serial.println("==================================================");
-        Serial.println("Debug output for target temperature update");
-        Serial.print("newTargetTemp: ");
-        Serial.println(newTargetTemp);
-        Serial.print("Target temperature updated to: ");
-        Serial.println(targetTemp);
-        Serial.println("==================================================");
+            Serial.println("==================================================");
+            Serial.println("Debug output for target temperature update");
+            Serial.print("Active setpoint: ");
+            Serial.println(formatTime(active.minuteOfDay / 60, active.minuteOfDay % 60));
+            Serial.print("Target temperature updated to: ");
+            Serial.println(targetTemp);
+            Serial.println("==================================================");
 #endif
+        }
+    }
+
+    updateResolutionPolicy(targetTemp); // Full precision only near the setpoint
+
+    // Report which probe(s) drive the decision whenever that changes
+    static uint8_t lastDriverMask = 0xFF;
+    if (input.driverMask != lastDriverMask)
+    {
+        lastDriverMask = input.driverMask;
+        postControlEvent({CONTROL_EVT_INPUT_CHANGED, input.driverMask, 0});
+    }
+
+    bool tripped = isSafetyTripped();
+    HeaterDemand demand = DEMAND_OFF;
+    if (input.valid && !tripped)
+    {
+        demand = (controlMode == CONTROL_MODE_PI) ? piDemand(controlTemp, targetTemp)
+                                                  : hysteresisDemand(controlTemp, targetTemp, HYSTERESIS_BAND);
     }
-    
-    publishSingleValue("esp32/control/targetTemperature", (float)(round(targetTemp * 10) / 10.0));
-    pushTargetTempToFirebase((float)(round(targetTemp * 10) / 10.0));
-    
-    const float HYSTERESIS = 0.25; // degrees - Balanced for responsive control while preventing oscillation
-    
+
     //***************************************
-    // Temperature above target + hysteresis - Turn OFF
+    // Safety cutout latched - heater OFF until reset
     //***************************************
-    if (tempRed > targetTemp + HYSTERESIS)
-    {
-        digitalWrite(RELAY_PIN, HIGH); // HIGH = Relay OFF
-        status.heater = HEATERS_OFF;
-        publishSystemData();
-        updateLEDs(status);
-        
-        // Check email timers even when heater is off (if single heater is failed)
-        if (SINGLE_HEATER_OFF)
-        {
-            unsigned long currentMillis = millis();
-            check_E_Mail_Timers(0.0, currentMillis); // Pass 0.0 as we don't have current reading when off
-        }
+    if (tripped)
+    {
+        lastPiUpdate = 0;
+        setRelay(false);
+        heaterState = HEATERS_OFF;
+#if DEBUG_SERIAL
+        Serial.println("🚨 Safety cutout latched - heater held OFF");
+#endif
+    }
+    //***************************************
+    // No usable probe - fail safe with the heater OFF
+    //***************************************
+    else if (!input.valid)
+    {
+        lastPiUpdate = 0; // Do not integrate across the gap
+        setRelay(false);
+        heaterState = HEATERS_OFF;
+#if DEBUG_SERIAL
+        Serial.println("🚨 No usable temperature probe - heater held OFF");
+#endif
+    }
+    //***************************************
+    // Temperature above target + hysteresis (or PI off-time) - Turn OFF
+    //***************************************
+    else if (demand == DEMAND_OFF)
+    {
+        setRelay(false);
+        heaterState = HEATERS_OFF;
 
 #if DEBUG_SERIAL
         Serial.println("❄️❄️❄️ Heater OFF ❄️❄️❄️");
         Serial.print("Current temp: ");
-        Serial.print(tempRed);
+        Serial.print(controlTemp);
         Serial.print("°C, Target: ");
         Serial.print(targetTemp);
         Serial.print("°C, Hysteresis: ");
-        Serial.println(HYSTERESIS);
+        Serial.println(HYSTERESIS_BAND);
+        Serial.print("Mode: ");
+        Serial.print(heaterControlModeToString(controlMode));
+        Serial.print(", duty: ");
+        Serial.println(heaterDuty, 2);
         Serial.println("❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️❄️");
 #endif
     }
     //***************************************
-    // Temperature below target - Turn ON and monitor heater state
+    // Temperature below target (or PI on-time) - Turn ON and monitor heater state
     //***************************************
-    else if (tempRed < targetTemp)
-    {
-        digitalWrite(RELAY_PIN, LOW); // LOW = Relay ON
-        double currentReading = getCurrentReading(); // Get current voltage reading for heater state analysis
-        HeaterState heaterState = getHeaterState(currentReading);
-        status.heater = heaterState;
-        updateLEDs(status);
-        
+    else if (demand == DEMAND_ON)
+    {
+        setRelay(true);
+        currentReading = getCurrentReading(); // Get current voltage reading for heater state analysis
+        // Straight after switching on, the latest window can predate the switch
+        if (isRelayCurrentSettled())
+        {
+            heaterState = getHeaterState(currentReading);
+        }
+
 #if DEBUG_SERIAL
         Serial.println("♨️♨️♨️ Heater ON ♨️♨️♨️");
         Serial.print("Current reading: ");
@@ -128,123 +387,197 @@ void updateHeaterControl(SystemStatus &status)
         Serial.println(" A");
         Serial.print("Heater state: ");
         Serial.println(heaterStateToString(heaterState));
+        Serial.print("Mode: ");
+        Serial.print(heaterControlModeToString(controlMode));
+        Serial.print(", duty: ");
+        Serial.println(heaterDuty, 2);
         Serial.println("♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️");
 #endif
-
-        publishSystemData();
-        unsigned long currentMillis = millis();
-        
-        // Handle ONE_HEATER_ON state
-        if (heaterState == ONE_HEATER_ON)
-        {
-#if DEBUG_SERIAL
-            Serial.println("⚠️⚠️⚠️ One heater detected as ON ⚠️⚠️⚠️");
-            Serial.print("Time since last email: ");
-            Serial.print((currentMillis - last_Single_Heater_Alert_Email));
-            Serial.println(" minutes");
-#endif
-            if (first_Run_Single_Heater_Alert)
-            {
-#if DEBUG_SERIAL
-                Serial.println("Sending FIRST single heater failure email");
-#endif
-                first_Run_Single_Heater_Alert = false;
-                last_Single_Heater_Alert_Email = currentMillis;
-                char message[200];
-                sprintf(message, "One heater has failed. Current: %.2fA (expected ~1.6-2.5A). System still operational but reduced efficiency.", currentReading);
-                sendEmail("WARNING: Single Heater Failure - Attention Needed", message);
-                SINGLE_HEATER_OFF = true;
-            }
-            else
-            {
-                // Check for reminder emails
-                check_E_Mail_Timers(currentReading, currentMillis);
-            }
-        }
-        // Handle BOTH_HEATERS_BLOWN state
-        else if (heaterState == BOTH_HEATERS_BLOWN)
-        {
-#if DEBUG_SERIAL
-            Serial.println("🚨🚨🚨 Both heaters detected as BLOWN 🚨🚨🚨");
-            Serial.print("Current reading: ");
-            Serial.print(currentReading, 2);
-            Serial.println(" A");
-            Serial.print("Time since last email: ");
-            Serial.print((currentMillis - last_Total_Failure_Email) / 60000);
-            Serial.println(" minutes");
-            Serial.print(" first_Run_Total_Failure: ");
-            Serial.println(first_Run_Total_Failure);
-#endif
-
-            if (first_Run_Total_Failure)
-            {
-#if DEBUG_SERIAL
-                Serial.println("Sending FIRST total failure email");
-#endif
-                first_Run_Total_Failure = false;
-                last_Total_Failure_Email = currentMillis;
-                char message[200];
-                sprintf(message, "Both heaters have failed! Current: %.2fA. Immediate attention required!", currentReading);
-                sendEmail("WARNING: Both Heater Failure - Attention Needed", message);
-            }
-            else if (currentMillis - last_Total_Failure_Email >= 1800000UL) // 30 minutes
-            {
-#if DEBUG_SERIAL
-                Serial.println("30 minutes elapsed - sending repeat total failure email");
-#endif
-                last_Total_Failure_Email = currentMillis;
-                char message[200];
-                sprintf(message, "Both heaters have failed! Current: %.2fA. Immediate attention required!", currentReading);
-                sendEmail("WARNING: Both Heater Failure - Attention Needed", message);
-            }
-        }
-        // Handle BOTH_HEATERS_ON state - Reset all failure flags
-        else if (heaterState == BOTH_HEATERS_ON)
-        {
-            if (!first_Run_Single_Heater_Alert || !first_Run_Total_Failure || SINGLE_HEATER_OFF)
-            {
-#if DEBUG_SERIAL
-                Serial.println("✅ Both heaters working properly - resetting all failure flags");
-#endif
-                first_Run_Single_Heater_Alert = true;
-                first_Run_Total_Failure = true;
-                SINGLE_HEATER_OFF = false;
-            }
-        }
     }
     //***************************************
     // Temperature within hysteresis band - maintain current state
     //***************************************
     else
     {
-        publishSystemData();
-        updateLEDs(status);
-
 #if DEBUG_SERIAL
         Serial.println("🌡️ Temperature within hysteresis band - maintaining current state");
 #endif
     }
-} // End of updateHeaterControl function
 
-// Function to refresh the cached schedule values
-// Call this whenever schedule data is updated via MQTT
-void refreshScheduleCache()
+    updateThermalPredictor(controlTemp, input.valid, relayCommandedOn);
+
+    // Current is watched in every relay state, not just while heating
+    RelayFault relayFault = updateRelayMonitor(relayCommandedOn);
+    static RelayFault lastRelayFault = RELAY_FAULT_NONE;
+    if (relayFault != lastRelayFault)
+    {
+        lastRelayFault = relayFault;
+        postControlEvent({CONTROL_EVT_RELAY_FAULT, relayFault, getRelayOffCurrent()});
+    }
+    if (relayFault == RELAY_FAULT_ENERGISED_WHEN_OFF && !relayCommandedOn)
+    {
+        heaterState = HEATER_ENERGISED_WHEN_OFF;
+    }
+
+    portENTER_CRITICAL(&controlLock);
+    controlSnapshot.heater = heaterState;
+    controlSnapshot.relayOn = relayCommandedOn;
+    controlSnapshot.current = currentReading;
+    controlSnapshot.relayFault = relayFault;
+    portEXIT_CRITICAL(&controlLock);
+}
+/**************************************
+ *   Relay decision (control task)    *
+ *           end                      *
+ *************************************/
+
+// Heater failure alerts while the relay is on, from the latest decision.
+// Only a confirmed BOTH_HEATERS_ON clears them.
+static void checkHeaterAlerts(HeaterState heaterState, double currentReading)
+{
+    char detail[ALERT_DETAIL_LEN];
+    if (heaterState == ONE_HEATER_ON)
+    {
+        snprintf(detail, sizeof(detail), "One heater has failed. Current: %.2fA (expected ~1.6-2.5A). System still operational but reduced efficiency.", currentReading);
+        raiseAlert(ALERT_SINGLE_HEATER_FAILED, detail);
+    }
+    else if (heaterState == BOTH_HEATERS_BLOWN)
+    {
+        snprintf(detail, sizeof(detail), "Both heaters have failed! Current: %.2fA. Immediate attention required!", currentReading);
+        raiseAlert(ALERT_BOTH_HEATERS_FAILED, detail);
+    }
+    else if (heaterState == BOTH_HEATERS_ON)
+    {
+        clearAlert(ALERT_SINGLE_HEATER_FAILED);
+        clearAlert(ALERT_BOTH_HEATERS_FAILED);
+    }
+}
+
+// Relay monitor faults map onto their alerts; a cleared fault clears both
+static void handleRelayFaultEvent(RelayFault fault, float offCurrent)
 {
-    forceScheduleRefresh = true;
+    publishSingleValue(TOPIC_RELAY_FAULT, relayFaultToString(fault));
+    char detail[ALERT_DETAIL_LEN];
+    if (fault == RELAY_FAULT_ENERGISED_WHEN_OFF)
+    {
+        snprintf(detail, sizeof(detail), "Heater current %.2fA is flowing with the relay commanded OFF. The relay contact may be welded - isolate the heaters at the mains!", offCurrent);
+        raiseAlert(ALERT_RELAY_ENERGISED_WHEN_OFF, detail);
+#if DEBUG_SERIAL
+        Serial.println("🚨🚨🚨 Heaters energised with relay OFF 🚨🚨🚨");
+#endif
+    }
+    else
+    {
+        clearAlert(ALERT_RELAY_ENERGISED_WHEN_OFF);
+    }
+
+    if (fault == RELAY_FAULT_LEAKAGE)
+    {
+        snprintf(detail, sizeof(detail), "%.2fA is flowing with the relay commanded OFF. Check the relay and wiring for leakage.", offCurrent);
+        raiseAlert(ALERT_RELAY_LEAKAGE, detail);
+    }
+    else
+    {
+        clearAlert(ALERT_RELAY_LEAKAGE);
+    }
 }
 
-// Function to check and send reminder emails for single heater failure
-void check_E_Mail_Timers(double currentReading, unsigned long currentMillis)
+/**************************************
+ *   Network side (loop)              *
+ *           start                    *
+ *************************************/
+// Called every loop() pass: feeds the clock to the control task, acts on
+// its events and reflects its latest decision in status, LEDs, MQTT,
+// Firebase and alerts. Blocking here no longer delays the relay.
+void updateHeaterControl(SystemStatus &status)
 {
-    // Check if 60 minutes have passed since last email attempt
-    if (currentMillis - last_Single_Heater_Alert_Email >= 3600000UL) // 3600000 ms = 60 minutes
+    getTime(); // Updates Hours and Minutes
+    AmFlag = (Hours < 12);
+    if (timeClient.isTimeSet())
+    {
+        setControlClock(timeClient.getEpochTime());
+    }
+
+    ControlEvent event;
+    while (receiveControlEvent(event))
     {
+        if (event.type == CONTROL_EVT_INPUT_CHANGED)
+        {
+            char drivers[32];
+            describeControlDrivers(event.code, drivers, sizeof(drivers));
+            publishSingleValue(TOPIC_CONTROL_INPUT, drivers);
 #if DEBUG_SERIAL
-        Serial.println("10 minutes elapsed - sending repeat single heater failure email");
+            Serial.print("Control input (");
+            Serial.print(controlPolicyToString(getControlPolicy()));
+            Serial.print("): ");
+            Serial.println(drivers);
 #endif
-        last_Single_Heater_Alert_Email = currentMillis;
-        char message[200];
-        sprintf(message, "One heater has failed. Current: %.2fA (expected ~1.6-2.5A). System still operational but reduced efficiency.", currentReading);
-        sendEmail("WARNING: Single Heater Failure - Attention Needed", message);
+        }
+        else if (event.type == CONTROL_EVT_RELAY_FAULT)
+        {
+            handleRelayFaultEvent((RelayFault)event.code, event.value);
+        }
     }
-}
\ No newline at end of file
+
+    portENTER_CRITICAL(&controlLock);
+    HeaterControlSnapshot snapshot = controlSnapshot;
+    portEXIT_CRITICAL(&controlLock);
+
+    if (snapshot.relayFault == RELAY_FAULT_ENERGISED_WHEN_OFF)
+    {
+        char detail[ALERT_DETAIL_LEN];
+        snprintf(detail, sizeof(detail), "Heaters are STILL energised with the relay commanded OFF (%.2fA). Isolate the heaters at the mains!", getRelayOffCurrent());
+        raiseAlert(ALERT_RELAY_ENERGISED_WHEN_OFF, detail); // Refreshes the reminder text
+    }
+
+    // Safety cutout changes go out as they happen; the alert repeats while latched
+    static uint8_t lastSafetyFaults = SAFETY_FAULT_NONE;
+    uint8_t safetyFaults = getSafetyFaults();
+    if (safetyFaults != lastSafetyFaults)
+    {
+        lastSafetyFaults = safetyFaults;
+        char faults[48];
+        describeSafetyFaults(safetyFaults, faults, sizeof(faults));
+        publishSingleValue(TOPIC_SAFETY, faults);
+        if (safetyFaults != SAFETY_FAULT_NONE)
+        {
+            char detail[ALERT_DETAIL_LEN];
+            snprintf(detail, sizeof(detail), "Safety cutout tripped (%s). The heaters are held OFF until React/control/safetyReset is sent.", faults);
+            raiseAlert(ALERT_SAFETY_CUTOUT, detail);
+        }
+        else
+        {
+            clearAlert(ALERT_SAFETY_CUTOUT);
+        }
+    }
+
+    saveControlStateIfChanged();
+
+    // Report by exception: unchanged values are only re-sent on their heartbeat
+    float target = (float)(round(targetTemp * 10) / 10.0);
+    if (getMQTTStatus() == MQTT_STATE_CONNECTED && shouldReport(REPORT_TARGET_MQTT, target))
+    {
+        publishSingleValue(TOPIC_TARGET_TEMP, target);
+    }
+    pushTargetTempToFirebase(target);
+
+    status.heater = snapshot.heater;
+    publishSystemData();
+    updateLEDs(status);
+
+    if (snapshot.relayOn)
+    {
+        checkHeaterAlerts(snapshot.heater, snapshot.current);
+    }
+}
+/**************************************
+ *   Network side (loop)              *
+ *           end                      *
+ *************************************/
+
+// Rebuilds the setpoint table from the AM/PM schedule
+// Call this whenever schedule data is updated via MQTT or Firebase
+void refreshScheduleCache()
+{
+    loadScheduleFromLegacy(currentSchedule);
+}
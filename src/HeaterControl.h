@@ -11,10 +11,28 @@ float getTargetTemp();
 #include "Config.h"
 #include "TimeManager.h"
 
+// How the relay decision is made
+enum HeaterControlMode : uint8_t
+{
+    CONTROL_MODE_HYSTERESIS, // On below target, off above target + hysteresis
+    CONTROL_MODE_PI          // PI duty over a time-proportioning window
+};
+
+#define CONTROL_STATE_SAVE_INTERVAL 900000 // ms between NVS checkpoints of the PI integral
+
 // Function declarations
-void updateHeaterControl(SystemStatus &status);
+void initHeaterControl(); // Restores target, mode and PI state from NVS
+void updateHeaterControl(SystemStatus &status); // loop(): publishing, LEDs and alerts
+void runHeaterControl();                        // Control task: sensing and relay decision
+void setHeaterControlMode(HeaterControlMode mode);
+HeaterControlMode getHeaterControlMode();
+const char *heaterControlModeToString(HeaterControlMode mode);
+bool parseHeaterControlMode(const String &text, HeaterControlMode &mode); // "hysteresis" | "pi"
+void setPiTuning(float kp, float integralTimeS);
+float getHeaterDuty(); // Latest PI output 0..1
 void refreshScheduleCache(); // Force refresh of cached schedule values
 void getTime();
 void publishSystemData();
-void check_E_Mail_Timers();
+void setRelay(bool on);     // Drives the active-low relay; the only place it is switched
+bool isRelayCommandedOn();  // What the relay was last told, not what the pin reads back
 #endif // HEATERCONTROL_H
@@ -0,0 +1,17 @@
+// ==================================================
+// File: src/HeaterState.h
+// ==================================================
+// Kept apart from Config.h so Arduino-free code (HeaterBands.h) can use it.
+
+#pragma once
+
+// Heater state enumeration for multi-heater detection
+enum HeaterState
+{
+    HEATER_STARTUP,    // Initial state during startup
+    HEATERS_OFF,       // <0.45A - No heaters working
+    ONE_HEATER_ON,     // 1.5-3.0A - One heater working
+    BOTH_HEATERS_ON,   // >3.5A - Both heaters working
+    BOTH_HEATERS_BLOWN, // ZERO current reading
+    HEATER_ENERGISED_WHEN_OFF // Heater current with the relay commanded OFF
+};
@@ -0,0 +1,288 @@
+// ==================================================
+// File: src/HistoryBlocks.cpp
+// ==================================================
+
+#include "HistoryBlocks.h"
+#include "OutboxRing.h"
+#include "RingFile.h"
+#include "SampleHistory.h"
+#include "TimeManager.h"
+#include "FirebaseService.h"
+#include <LittleFS.h>
+
+#define HISTORY_BLOCK_MAGIC 0x48424C4B // "HBLK"
+#define HISTORY_BLOCK_FILE_MAGIC 0x48424C46 // "HBLF"
+
+// One UTC hour, in centi-degrees like SampleHistory
+struct HistoryBlock
+{
+    uint32_t hourStart; // UTC epoch of slot 0, 0 if the block is unused
+    int16_t centi[HISTORY_BLOCK_PROBES][HISTORY_BLOCK_SLOTS];
+};
+
+struct OpenBlockState
+{
+    uint32_t magic;
+    HistoryBlock block;
+};
+
+// The open hour survives a soft reset in RTC memory; a power cut loses it
+RTC_NOINIT_ATTR static OpenBlockState open;
+
+// One slot of the closed-block ring
+struct StoredBlock
+{
+    HistoryBlock block;
+    uint32_t check;
+};
+
+// Closed hours waiting for Firebase; the ring bookkeeping is the outbox's
+// (OutboxRing.h, RingFile.h)
+static RingFile closed = {HISTORY_BLOCK_STATE_FILE, HISTORY_BLOCK_SEGMENT_FILE, HISTORY_BLOCK_FILE_MAGIC,
+                          sizeof(StoredBlock), HISTORY_BLOCK_PENDING, {}};
+static bool mounted = false;
+
+static HistoryBlockStats stats = {};
+static uint32_t lastRowTimestamp = 0;
+
+static void startBlock(HistoryBlock &block, uint32_t hourStart)
+{
+    block.hourStart = hourStart;
+    for (int p = 0; p < HISTORY_BLOCK_PROBES; p++)
+    {
+        for (int i = 0; i < HISTORY_BLOCK_SLOTS; i++)
+        {
+            block.centi[p][i] = HISTORY_INVALID;
+        }
+    }
+}
+
+static bool blockHasData(const HistoryBlock &block)
+{
+    for (int p = 0; p < HISTORY_BLOCK_PROBES; p++)
+    {
+        for (int i = 0; i < HISTORY_BLOCK_SLOTS; i++)
+        {
+            if (block.centi[p][i] != HISTORY_INVALID)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// FNV-1a over the block, so a slot torn by a power cut is not uploaded
+static uint32_t blockCheck(const HistoryBlock &block)
+{
+    const uint8_t *bytes = (const uint8_t *)&block;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(block); i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Written to flash before anything is sent. A full ring drops its oldest
+// block, so the newest history survives.
+static void queueClosedBlock(const HistoryBlock &block)
+{
+    if (!mounted)
+    {
+        stats.evicted++;
+        return;
+    }
+
+    StoredBlock stored;
+    stored.block = block;
+    stored.check = blockCheck(block);
+    OutboxRing next = closed.ring;
+    bool evicted = false;
+    uint32_t slot = outboxRingPush(next, &evicted);
+    bool ok = ringFileWrite(closed, slot, &stored) && ringFileSave(closed, next);
+    if (!ok || evicted)
+    {
+        stats.evicted++;
+    }
+}
+
+// Drops the oldest stored block once it is written or unreadable
+static void popClosedBlock()
+{
+    OutboxRing next = closed.ring;
+    outboxRingPop(next, 1);
+    ringFileSave(closed, next);
+}
+
+static size_t formatBlock(const HistoryBlock &block, char *out, size_t len)
+{
+    static const char *names[HISTORY_BLOCK_PROBES] = {"red", "blue", "green"};
+    size_t used = snprintf(out, len, "{\"t0\":%lu,\"dt\":%d",
+                           (unsigned long)block.hourStart, HISTORY_BLOCK_INTERVAL_S);
+    for (int p = 0; p < HISTORY_BLOCK_PROBES && used < len; p++)
+    {
+        used += snprintf(out + used, len - used, ",\"%s\":[", names[p]);
+        for (int i = 0; i < HISTORY_BLOCK_SLOTS && used < len; i++)
+        {
+            int16_t value = block.centi[p][i];
+            if (value == HISTORY_INVALID)
+            {
+                used += snprintf(out + used, len - used, "%snull", i ? "," : "");
+            }
+            else
+            {
+                used += snprintf(out + used, len - used, "%s%.2f", i ? "," : "", fromCentiUnits(value));
+            }
+        }
+        if (used < len)
+        {
+            used += snprintf(out + used, len - used, "]");
+        }
+    }
+    if (used < len)
+    {
+        used += snprintf(out + used, len - used, "}");
+    }
+    return used;
+}
+
+/**************************************
+ *   Write closed blocks              *
+ *           start                    *
+ *************************************/
+// One PUT per closed hour, oldest first; a block leaves the ring file only
+// once Firebase has accepted it
+static void publishPendingBlocks()
+{
+    static unsigned long lastAttempt = 0;
+    if (!mounted || closed.ring.count == 0 || !fbInitialized ||
+        (lastAttempt != 0 && millis() - lastAttempt < 30000))
+    {
+        return; // Retry failed writes at most every 30 seconds
+    }
+    lastAttempt = millis();
+
+    StoredBlock stored;
+    if (!ringFileRead(closed, outboxRingSlot(closed.ring, 0), &stored))
+    {
+        return;
+    }
+    if (stored.check != blockCheck(stored.block) || stored.block.hourStart % 3600 != 0)
+    {
+        stats.corrupt++;
+        popClosedBlock();
+        return;
+    }
+
+    const HistoryBlock &block = stored.block;
+    static char payload[HISTORY_BLOCK_PAYLOAD_LEN];
+    size_t bytes = formatBlock(block, payload, sizeof(payload));
+    if (bytes >= sizeof(payload))
+    {
+        popClosedBlock(); // Cannot happen with the sizes above
+        return;
+    }
+
+    time_t hourStart = block.hourStart;
+    char path[64];
+    strftime(path, sizeof(path), "ESP32/history/blocks/%Y-%m-%d/%H", gmtime(&hourStart));
+
+    FirebaseJson json;
+    json.setJsonData(payload);
+    unsigned long start = millis();
+    bool ok = Firebase.RTDB.setJSON(&fbData, path, &json);
+    stats.lastLatencyMs = millis() - start;
+    stats.lastBytes = bytes;
+    if (!ok)
+    {
+        stats.failures++;
+        return;
+    }
+    stats.written++;
+    popClosedBlock();
+}
+/**************************************
+ *   Write closed blocks              *
+ *           end                      *
+ *************************************/
+
+void initHistoryBlocks()
+{
+    if (open.magic != HISTORY_BLOCK_MAGIC)
+    {
+        open.magic = HISTORY_BLOCK_MAGIC;
+        startBlock(open.block, 0);
+    }
+
+    if (!LittleFS.begin(true)) // Formats the data partition on first use
+    {
+        Serial.println("History blocks: LittleFS mount failed");
+        return;
+    }
+    if (LittleFS.exists(HISTORY_BLOCK_LEGACY_FILE))
+    {
+        LittleFS.remove(HISTORY_BLOCK_LEGACY_FILE);
+    }
+    if (!ringFileOpen(closed))
+    {
+        Serial.println("History blocks: cannot create ring files");
+        return;
+    }
+    mounted = true;
+    Serial.print("History blocks: ");
+    Serial.print(closed.ring.count);
+    Serial.println(" closed hours waiting");
+}
+
+/**************************************
+ *   Fill the open hour               *
+ *           start                    *
+ *************************************/
+// Call every loop pass. The newest SampleHistory row goes into the slot
+// for the current UTC time; within a slot the latest valid reading wins.
+void updateHistoryBlocks()
+{
+    time_t utc;
+    if (getUtcEpoch(utc))
+    {
+        uint32_t hourStart = utc - utc % 3600;
+        if (open.block.hourStart != hourStart)
+        {
+            if (open.block.hourStart != 0 && blockHasData(open.block))
+            {
+                queueClosedBlock(open.block);
+            }
+            startBlock(open.block, hourStart);
+        }
+
+        HistorySample row;
+        if (getLatestHistorySample(row) && row.timestamp != lastRowTimestamp)
+        {
+            lastRowTimestamp = row.timestamp;
+            uint32_t slot = (utc - hourStart) / HISTORY_BLOCK_INTERVAL_S;
+            for (int p = 0; p < HISTORY_BLOCK_PROBES; p++)
+            {
+                int16_t value = row.value[HISTORY_RED + p];
+                if (value != HISTORY_INVALID || open.block.centi[p][slot] == HISTORY_INVALID)
+                {
+                    open.block.centi[p][slot] = value;
+                }
+            }
+        }
+    }
+
+    publishPendingBlocks();
+}
+/**************************************
+ *   Fill the open hour               *
+ *           end                      *
+ *************************************/
+
+HistoryBlockStats getHistoryBlockStats()
+{
+    HistoryBlockStats copy = stats;
+    copy.pending = closed.ring.count;
+    copy.mounted = mounted;
+    return copy;
+}
@@ -0,0 +1,40 @@
+// ==================================================
+// File: src/HistoryBlocks.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Batched history (HISTORY_BLOCK_MODE). Samples fill an in-RAM block for
+// the current UTC hour, and each closed hour is written with a single PUT
+// to ESP32/history/blocks/<YYYY-MM-DD>/<HH> in a columnar layout:
+//   {"t0":1730973600,"dt":60,"red":[21.5,21.56,null,...],"blue":[...],"green":[...]}
+// Sample i was taken at t0 + i*dt; null marks a slot with no valid reading.
+// Closed hours wait in a ring on LittleFS (RingFile.h) until Firebase accepts them,
+// so neither an outage nor a reboot loses them.
+#define HISTORY_BLOCK_INTERVAL_S 60 // Slot width
+#define HISTORY_BLOCK_SLOTS (3600 / HISTORY_BLOCK_INTERVAL_S)
+#define HISTORY_BLOCK_PROBES 3      // Red, blue, green
+#define HISTORY_BLOCK_STATE_FILE "/history_blocks.idx"
+#define HISTORY_BLOCK_SEGMENT_FILE "/history_blocks_%02u.bin"
+#define HISTORY_BLOCK_LEGACY_FILE "/history_blocks.bin" // Single-file ring of earlier builds, removed at boot
+#define HISTORY_BLOCK_PENDING 48    // Closed hours held while Firebase is unreachable (~18 KB)
+#define HISTORY_BLOCK_PAYLOAD_LEN 1600
+
+struct HistoryBlockStats
+{
+    uint32_t written;   // Blocks accepted by Firebase
+    uint32_t failures;  // Failed PUTs; the block is retried
+    uint32_t evicted;   // Closed blocks dropped because the ring was full or not writable
+    uint32_t corrupt;   // Stored blocks skipped on a bad checksum
+    uint32_t lastBytes; // Payload of the last PUT
+    uint32_t lastLatencyMs;
+    uint32_t pending;
+    bool mounted;       // Ring files open on LittleFS
+};
+
+// Function declarations
+void initHistoryBlocks();   // Opens the closed-block ring and resumes the open hour from RTC memory
+void updateHistoryBlocks(); // loop(); fills the open block and writes closed ones
+HistoryBlockStats getHistoryBlockStats();
@@ -0,0 +1,197 @@
+// ==================================================
+// File: src/HistoryOutbox.cpp
+// ==================================================
+
+#include "HistoryOutbox.h"
+#include "OutboxRing.h"
+#include "RingFile.h"
+#include "SampleHistory.h"
+#include "FirebaseService.h"
+#include "Config.h"
+#include <LittleFS.h>
+#include <time.h>
+
+#define OUTBOX_MAGIC 0x48424F58 // "HBOX"
+
+static RingFile outbox = {OUTBOX_STATE_FILE, OUTBOX_SEGMENT_FILE, OUTBOX_MAGIC,
+                          sizeof(OutboxRecord), OUTBOX_CAPACITY, {}};
+static bool mounted = false;
+static OutboxStats stats = {};
+
+bool initHistoryOutbox()
+{
+    if (!LittleFS.begin(true)) // Formats the data partition on first use
+    {
+        Serial.println("History outbox: LittleFS mount failed");
+        return false;
+    }
+    if (LittleFS.exists(OUTBOX_LEGACY_FILE))
+    {
+        LittleFS.remove(OUTBOX_LEGACY_FILE);
+    }
+    if (!ringFileOpen(outbox))
+    {
+        Serial.println("History outbox: cannot create ring files");
+        return false;
+    }
+
+    mounted = true;
+    Serial.print("History outbox: ");
+    Serial.print(outbox.ring.count);
+    Serial.println(" records waiting");
+    return true;
+}
+
+bool appendHistoryRecord(time_t epoch, float tempRed, float tempBlue, float tempGreen)
+{
+    if (!mounted || epoch < 1000000000)
+    {
+        return false; // No filesystem, or no NTP time to file the record under
+    }
+
+    OutboxRecord record;
+    record.epoch = (uint32_t)epoch;
+    record.centi[0] = toCentiUnits(tempRed);
+    record.centi[1] = toCentiUnits(tempBlue);
+    record.centi[2] = toCentiUnits(tempGreen);
+    record.check = outboxRecordCheck(record);
+
+    OutboxRing next = outbox.ring;
+    bool evicted = false;
+    uint32_t slot = outboxRingPush(next, &evicted);
+    bool ok = ringFileWrite(outbox, slot, &record) && ringFileSave(outbox, next);
+
+    if (ok)
+    {
+        stats.appended++;
+        if (evicted)
+        {
+            stats.evicted++;
+        }
+    }
+    return ok;
+}
+
+// "daily/2024-11-07/10-30-00":{...} in the shape the live writer used
+static int formatRecord(const OutboxRecord &record, char *out, size_t len)
+{
+    time_t epoch = record.epoch;
+    struct tm *timeinfo = gmtime(&epoch);
+    char dateKey[16];
+    char timeKey[16];
+    char isoTimestamp[32];
+    strftime(dateKey, sizeof(dateKey), "%Y-%m-%d", timeinfo);
+    strftime(timeKey, sizeof(timeKey), "%H-%M-%S", timeinfo);
+    strftime(isoTimestamp, sizeof(isoTimestamp), "%Y-%m-%dT%H:%M:%SZ", timeinfo);
+
+    const char *names[3] = {"tempRed", "tempBlue", "tempGreen"};
+    float temps[3];
+    char fields[96];
+    size_t used = 0;
+    fields[0] = '\0';
+    for (int i = 0; i < 3; i++)
+    {
+        temps[i] = record.centi[i] == HISTORY_INVALID ? NAN : fromCentiUnits(record.centi[i]);
+        if (!isnan(temps[i]))
+        {
+            used += snprintf(fields + used, sizeof(fields) - used, "\"%s\":%.2f,", names[i], temps[i]);
+        }
+    }
+
+    return snprintf(out, len,
+                    "\"daily/%s/%s\":{%s\"timestamp\":%lu,\"iso\":\"%s\","
+                    "\"chartData\":\"{\\\"x\\\":\\\"%s\\\",\\\"red\\\":%.2f,\\\"blue\\\":%.2f,\\\"green\\\":%.2f}\"}",
+                    dateKey, timeKey, fields, (unsigned long)record.epoch, isoTimestamp, isoTimestamp,
+                    isnan(temps[0]) ? 0.0 : temps[0],
+                    isnan(temps[1]) ? 0.0 : temps[1],
+                    isnan(temps[2]) ? 0.0 : temps[2]);
+}
+
+/**************************************
+ *   Replay (loop)                    *
+ *           start                    *
+ *************************************/
+// Sends up to OUTBOX_REPLAY_BATCH of the oldest records in one multi-path
+// update under ESP32/history and drops them from the ring only once
+// Firebase has accepted them. "latest" follows the newest record sent.
+void drainHistoryOutbox()
+{
+    static unsigned long lastReplay = 0;
+    static unsigned long replayInterval = OUTBOX_REPLAY_INTERVAL_MS; // Backs off while updates fail
+    if (!mounted || outbox.ring.count == 0 || !fbInitialized ||
+        millis() - lastReplay < replayInterval)
+    {
+        return;
+    }
+    lastReplay = millis();
+
+    static char payload[OUTBOX_PAYLOAD_LEN];
+    size_t used = 0;
+    payload[used++] = '{';
+    OutboxBatch batch = outboxCollectBatch(
+        outbox.ring, OUTBOX_REPLAY_BATCH,
+        [&](uint32_t slot, OutboxRecord &record)
+        {
+            return ringFileRead(outbox, slot, &record);
+        },
+        [&](const OutboxRecord &record, uint32_t index)
+        {
+            char entry[320];
+            int length = formatRecord(record, entry, sizeof(entry));
+            if (length <= 0 || used + length + 80 >= sizeof(payload))
+            {
+                return false;
+            }
+            used += snprintf(payload + used, sizeof(payload) - used, "%s%s", index ? "," : "", entry);
+            return true;
+        });
+    stats.corrupt += batch.corrupt;
+
+    bool delivered = true;
+    if (batch.sent > 0)
+    {
+        time_t epoch = batch.newestEpoch;
+        struct tm *timeinfo = gmtime(&epoch);
+        char latest[64];
+        strftime(latest, sizeof(latest), "ESP32/history/daily/%Y-%m-%d/%H-%M-%S", timeinfo);
+        used += snprintf(payload + used, sizeof(payload) - used, ",\"latest\":\"%s\"}", latest);
+
+        FirebaseJson json;
+        json.setJsonData(payload);
+        unsigned long start = millis();
+        delivered = Firebase.RTDB.updateNode(&fbData, "ESP32/history", &json);
+        stats.lastLatencyMs = millis() - start;
+        replayInterval = outboxNextInterval(replayInterval, delivered,
+                                            OUTBOX_REPLAY_INTERVAL_MS, OUTBOX_REPLAY_MAX_BACKOFF_MS);
+        if (delivered)
+        {
+            stats.delivered += batch.sent;
+        }
+        else
+        {
+            stats.failures++;
+#if DEBUG_SERIAL
+            Serial.print("History replay failed: ");
+            Serial.println(fbData.errorReason());
+#endif
+        }
+    }
+
+    OutboxRing next = outbox.ring;
+    if (outboxCompleteBatch(next, batch, delivered))
+    {
+        ringFileSave(outbox, next);
+    }
+}
+/**************************************
+ *   Replay (loop)                    *
+ *           end                      *
+ *************************************/
+
+OutboxStats getOutboxStats()
+{
+    OutboxStats copy = stats;
+    copy.pending = outbox.ring.count;
+    copy.mounted = mounted;
+    return copy;
+}
@@ -0,0 +1,39 @@
+// ==================================================
+// File: src/HistoryOutbox.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+
+// Store-and-forward for ESP32/history. Every history sample is appended to
+// a fixed-size ring on LittleFS (RingFile.h) with its acquisition time, and the
+// ring is drained to Firebase oldest first, a few records per multi-path
+// update, whenever Firebase is reachable. An outage leaves records waiting
+// instead of holes in the chart; one longer than the ring evicts the
+// oldest records first.
+#define OUTBOX_STATE_FILE "/history_outbox.idx"
+#define OUTBOX_SEGMENT_FILE "/history_outbox_%02u.bin"
+#define OUTBOX_LEGACY_FILE "/history_outbox.bin" // Single-file ring of earlier builds, removed at boot
+#define OUTBOX_CAPACITY 4320           // Records (30 days at the 10-minute history interval)
+#define OUTBOX_REPLAY_BATCH 8          // Records per Firebase update
+#define OUTBOX_REPLAY_INTERVAL_MS 5000 // Minimum gap between replay updates
+#define OUTBOX_REPLAY_MAX_BACKOFF_MS 300000 // Gap grows to this while updates fail
+#define OUTBOX_PAYLOAD_LEN 2560
+
+struct OutboxStats
+{
+    uint32_t pending;     // Records waiting in the ring
+    uint32_t appended;
+    uint32_t delivered;
+    uint32_t evicted;     // Oldest records overwritten while the ring was full
+    uint32_t failures;    // Failed replay updates
+    uint32_t corrupt;     // Records skipped on a bad checksum
+    uint32_t lastLatencyMs;
+    bool mounted;
+};
+
+// Function declarations
+bool initHistoryOutbox(); // Mounts LittleFS and opens (or creates) the ring
+bool appendHistoryRecord(time_t epoch, float tempRed, float tempBlue, float tempGreen); // false: not stored
+void drainHistoryOutbox(); // loop(); at most one batch per OUTBOX_REPLAY_INTERVAL_MS
+OutboxStats getOutboxStats();
@@ -0,0 +1,247 @@
+// ==================================================
+// File: src/HistoryRetention.cpp
+// ==================================================
+
+#include "HistoryRetention.h"
+#include "FirebaseService.h"
+#include "TimeManager.h"
+#include "Config.h"
+
+// Trees keyed by date; rollups are small and kept
+static const char *retentionPaths[] = {"ESP32/history/daily", "ESP32/history/blocks"};
+static const int RETENTION_PATH_COUNT = sizeof(retentionPaths) / sizeof(retentionPaths[0]);
+
+static RetentionState state = RETENTION_IDLE;
+static int pathIndex = 0; // Tree the pass is working on
+static RetentionStats stats = {};
+
+// Expired date keys from the last listing, deleted from the front
+static char expired[RETENTION_MAX_KEYS][11]; // "YYYY-MM-DD"
+static int expiredCount = 0;
+static int expiredNext = 0;
+static bool moreExpired = false; // The listing had more keys than fit
+
+static unsigned long lastPass = 0;
+static bool passRequested = false;
+static unsigned long lastStep = 0;
+static unsigned long passStart = 0;
+static uint32_t passRemoved = 0;
+static uint32_t passBusyMs = 0;
+static uint8_t failures = 0;
+
+static void finishPass(bool completed)
+{
+    state = RETENTION_IDLE;
+    lastPass = millis();
+    if (!completed)
+    {
+        stats.abandoned++;
+        Serial.println("History retention: pass abandoned after repeated failures");
+        return;
+    }
+    stats.passes++;
+    stats.lastRemoved = passRemoved;
+    stats.totalRemoved += passRemoved;
+    stats.lastDurationMs = millis() - passStart;
+    stats.lastBusyMs = passBusyMs;
+    Serial.print("History retention: removed ");
+    Serial.print(passRemoved);
+    Serial.print(" day(s) in ");
+    Serial.print(stats.lastDurationMs);
+    Serial.println(" ms");
+}
+
+static bool noteFailure()
+{
+    if (++failures >= RETENTION_MAX_FAILURES)
+    {
+        finishPass(false);
+        return false;
+    }
+    return true;
+}
+
+// Moves the pass on to the next tree, or ends it after the last one
+static void nextPathOrFinish()
+{
+    if (++pathIndex < RETENTION_PATH_COUNT)
+    {
+        state = RETENTION_LISTING;
+        return;
+    }
+    finishPass(true);
+}
+
+// Shallow GET returns {"2024-08-01":true,...}: keys only, no samples
+static void listExpiredKeys()
+{
+    time_t now;
+    getUtcEpoch(now); // Checked before the pass started
+    time_t cutoff = now - (time_t)HISTORY_RETENTION_DAYS * 24 * 60 * 60;
+    char cutoffDate[16];
+    strftime(cutoffDate, sizeof(cutoffDate), "%Y-%m-%d", gmtime(&cutoff));
+
+    unsigned long start = millis();
+    bool ok = Firebase.RTDB.getShallowData(&fbData, retentionPaths[pathIndex]);
+    passBusyMs += millis() - start;
+    if (!ok)
+    {
+        noteFailure();
+        return;
+    }
+    failures = 0;
+
+    expiredCount = 0;
+    expiredNext = 0;
+    moreExpired = false;
+    FirebaseJson &json = fbData.jsonObject();
+    size_t entries = json.iteratorBegin();
+    for (size_t i = 0; i < entries; i++)
+    {
+        int type;
+        String key;
+        String value;
+        json.iteratorGet(i, type, key, value);
+        // Date keys compare correctly as strings
+        if (key.length() != 10 || strcmp(key.c_str(), cutoffDate) >= 0)
+        {
+            continue;
+        }
+        if (expiredCount < RETENTION_MAX_KEYS)
+        {
+            strcpy(expired[expiredCount++], key.c_str());
+        }
+        else
+        {
+            moreExpired = true;
+        }
+    }
+    json.iteratorEnd();
+
+    if (expiredCount == 0)
+    {
+        nextPathOrFinish();
+        return;
+    }
+    state = RETENTION_DELETING;
+}
+
+// {"2024-08-01":null,...} PATCHed at the tree root deletes whole days
+static void deleteExpiredBatch()
+{
+    char payload[RETENTION_DELETE_BATCH * 20 + 4];
+    size_t used = snprintf(payload, sizeof(payload), "{");
+    int batch = 0;
+    for (int i = expiredNext; i < expiredCount && batch < RETENTION_DELETE_BATCH; i++, batch++)
+    {
+        used += snprintf(payload + used, sizeof(payload) - used, "%s\"%s\":null", batch ? "," : "", expired[i]);
+    }
+    snprintf(payload + used, sizeof(payload) - used, "}");
+
+    FirebaseJson json;
+    json.setJsonData(payload);
+    unsigned long start = millis();
+    bool ok = Firebase.RTDB.updateNode(&fbData, retentionPaths[pathIndex], &json);
+    passBusyMs += millis() - start;
+    if (!ok)
+    {
+        noteFailure();
+        return;
+    }
+    failures = 0;
+    expiredNext += batch;
+    passRemoved += batch;
+
+    if (expiredNext >= expiredCount)
+    {
+        if (moreExpired)
+        {
+            state = RETENTION_LISTING; // List again for the keys that did not fit
+        }
+        else
+        {
+            nextPathOrFinish();
+        }
+    }
+}
+
+/**************************************
+ *   Retention state machine (loop)   *
+ *           start                    *
+ *************************************/
+void updateHistoryRetention()
+{
+    if (!fbInitialized)
+    {
+        return;
+    }
+    unsigned long now = millis();
+
+    if (state == RETENTION_IDLE)
+    {
+        bool due = passRequested ||
+                   (stats.passes == 0 && stats.abandoned == 0 ? now >= RETENTION_FIRST_RUN_DELAY
+                                                               : now - lastPass >= RETENTION_RUN_INTERVAL);
+        time_t utc;
+        if (!due || !getUtcEpoch(utc)) // The cutoff needs NTP time
+        {
+            return;
+        }
+        passRequested = false;
+        passStart = now;
+        passRemoved = 0;
+        passBusyMs = 0;
+        failures = 0;
+        pathIndex = 0;
+        state = RETENTION_LISTING;
+    }
+
+    if (now - lastStep < RETENTION_STEP_INTERVAL)
+    {
+        return;
+    }
+    lastStep = now;
+
+    switch (state)
+    {
+    case RETENTION_LISTING:
+        listExpiredKeys();
+        break;
+    case RETENTION_DELETING:
+        deleteExpiredBatch();
+        break;
+    default:
+        break;
+    }
+}
+/**************************************
+ *   Retention state machine (loop)   *
+ *           end                      *
+ *************************************/
+
+void requestHistoryRetention()
+{
+    passRequested = true;
+}
+
+RetentionStats getRetentionStats()
+{
+    RetentionStats copy = stats;
+    copy.state = state;
+    return copy;
+}
+
+const char *retentionStateToString(RetentionState state)
+{
+    switch (state)
+    {
+    case RETENTION_IDLE:
+        return "IDLE";
+    case RETENTION_LISTING:
+        return "LISTING";
+    case RETENTION_DELETING:
+        return "DELETING";
+    default:
+        return "UNKNOWN";
+    }
+}
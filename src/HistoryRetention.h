@@ -0,0 +1,43 @@
+// ==================================================
+// File: src/HistoryRetention.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+
+// Retention for the per-date history trees (ESP32/history/daily/<YYYY-MM-DD>
+// and ESP32/history/blocks/<YYYY-MM-DD>). Once a day a pass lists each
+// tree's date keys with a shallow query and deletes the expired ones in
+// batched multi-path null updates. Each loop() call does at most one
+// Firebase request, so a pass is spread over many loop passes.
+#define HISTORY_RETENTION_DAYS 90
+#define RETENTION_RUN_INTERVAL 86400000UL // ms between passes
+#define RETENTION_FIRST_RUN_DELAY 300000  // ms after boot before the first pass
+#define RETENTION_STEP_INTERVAL 2000      // ms between requests within a pass
+#define RETENTION_MAX_KEYS 32             // Expired keys held per listing
+#define RETENTION_DELETE_BATCH 8          // Date keys per null update
+#define RETENTION_MAX_FAILURES 3          // Failed requests before a pass is abandoned
+
+enum RetentionState : uint8_t
+{
+    RETENTION_IDLE,     // Waiting for the next pass
+    RETENTION_LISTING,  // Shallow query of the date keys
+    RETENTION_DELETING  // Null updates for the expired keys
+};
+
+struct RetentionStats
+{
+    RetentionState state;
+    uint32_t passes;         // Completed passes
+    uint32_t abandoned;      // Passes given up after repeated failures
+    uint32_t lastRemoved;    // Date nodes removed by the last completed pass
+    uint32_t totalRemoved;
+    uint32_t lastDurationMs; // First request to last, including the gaps
+    uint32_t lastBusyMs;     // Time spent inside Firebase calls
+};
+
+// Function declarations
+void updateHistoryRetention();   // loop(); one step of the state machine when due
+void requestHistoryRetention();  // Start a pass on the next call
+RetentionStats getRetentionStats();
+const char *retentionStateToString(RetentionState state);
@@ -0,0 +1,266 @@
+// ==================================================
+// File: src/HistoryRollup.cpp
+// ==================================================
+
+#include "HistoryRollup.h"
+#include "BucketQueue.h"
+#include <Preferences.h>
+#include "SampleHistory.h"
+#include "HeaterControl.h"
+#include "TimeManager.h"
+#include "FirebaseService.h"
+
+#define ROLLUP_STATE_MAGIC 0x524F4C32 // "ROL2"
+
+// Everything needed to resume after a reboot, including closed buckets
+// still waiting for Firebase
+struct RollupState
+{
+    uint32_t magic;
+    uint32_t dayKey; // YYYYMMDD of the open day bucket, 0 before the clock is set
+    int32_t hour;    // Hour of the open hour bucket, -1 before the clock is set
+    RollupBucket hourBucket;
+    RollupBucket dayBucket;
+    BucketQueue<RollupBucket, BUCKET_QUEUE_HOURS> closedHours;
+    BucketQueue<RollupBucket, BUCKET_QUEUE_DAYS> closedDays;
+};
+
+// Survives a soft reset in RTC memory; NVS covers power loss
+RTC_NOINIT_ATTR static RollupState state;
+
+static uint32_t lastRowTimestamp = 0;
+static unsigned long lastSave = 0;
+
+static void saveRollupState()
+{
+    Preferences prefs;
+    prefs.begin("rollup", false);
+    prefs.putBytes("state", &state, sizeof(state));
+    prefs.end();
+    lastSave = millis();
+}
+
+static void clearBucket(RollupBucket &bucket)
+{
+    memset(&bucket, 0, sizeof(bucket));
+}
+
+static void addRow(RollupBucket &bucket, const HistorySample &row, bool relayOn)
+{
+    for (int i = 0; i < ROLLUP_PROBES; i++)
+    {
+        int16_t value = row.value[HISTORY_RED + i];
+        if (value == HISTORY_INVALID)
+        {
+            continue;
+        }
+        RollupChannel &channel = bucket.probe[i];
+        if (channel.count == 0 || value < channel.min)
+        {
+            channel.min = value;
+        }
+        if (channel.count == 0 || value > channel.max)
+        {
+            channel.max = value;
+        }
+        channel.sum += value;
+        channel.count++;
+    }
+    bucket.samples++;
+    if (relayOn)
+    {
+        bucket.onSamples++;
+    }
+}
+
+// {"red":{"min":20.1,"max":21.3,"avg":20.72,"n":360},...,"duty":41.7,"n":360}
+// A probe with no valid sample in the bucket is left out
+static void bucketToJson(const RollupBucket &bucket, FirebaseJson &json)
+{
+    const char *names[ROLLUP_PROBES] = {"red", "blue", "green"};
+    char key[16];
+    for (int i = 0; i < ROLLUP_PROBES; i++)
+    {
+        const RollupChannel &channel = bucket.probe[i];
+        if (channel.count == 0)
+        {
+            continue;
+        }
+        snprintf(key, sizeof(key), "%s/min", names[i]);
+        json.set(key, fromCentiUnits(channel.min));
+        snprintf(key, sizeof(key), "%s/max", names[i]);
+        json.set(key, fromCentiUnits(channel.max));
+        snprintf(key, sizeof(key), "%s/avg", names[i]);
+        json.set(key, (float)channel.sum / channel.count / 100.0f);
+        snprintf(key, sizeof(key), "%s/n", names[i]);
+        json.set(key, (int)channel.count);
+    }
+    json.set("duty", bucket.samples ? 100.0f * bucket.onSamples / bucket.samples : 0.0f);
+    json.set("n", (int)bucket.samples);
+}
+
+/**************************************
+ *   Publish closed rollup buckets    *
+ *           start                    *
+ *************************************/
+// One Firebase write per closed bucket, oldest first and one bucket of
+// each kind per pass, in the same way as the energy rollups
+static void publishPendingRollups()
+{
+    static unsigned long lastAttempt = 0;
+    static unsigned long retryInterval = 0;
+    if (!fbInitialized || (lastAttempt != 0 && millis() - lastAttempt < retryInterval))
+    {
+        return;
+    }
+    lastAttempt = millis();
+    retryInterval = BUCKET_BACKLOG_INTERVAL_MS;
+
+    char dateKey[16];
+    char path[64];
+    bool changed = false;
+
+    if (state.closedHours.count > 0)
+    {
+        const ClosedBucket<RollupBucket> &closed = bucketQueueFront(state.closedHours);
+        formatDayKey(closed.dayKey, dateKey, sizeof(dateKey));
+        snprintf(path, sizeof(path), "ESP32/history/rollup/hourly/%s/%02ld", dateKey, (long)closed.hour);
+
+        FirebaseJson json;
+        bucketToJson(closed.bucket, json);
+        if (Firebase.RTDB.setJSON(&fbData, path, &json))
+        {
+            bucketQueuePop(state.closedHours);
+            changed = true;
+        }
+        else
+        {
+            retryInterval = BUCKET_RETRY_INTERVAL_MS;
+        }
+    }
+
+    if (state.closedDays.count > 0)
+    {
+        const ClosedBucket<RollupBucket> &closed = bucketQueueFront(state.closedDays);
+        formatDayKey(closed.dayKey, dateKey, sizeof(dateKey));
+        snprintf(path, sizeof(path), "ESP32/history/rollup/daily/%s", dateKey);
+
+        FirebaseJson json;
+        bucketToJson(closed.bucket, json);
+        if (Firebase.RTDB.setJSON(&fbData, path, &json))
+        {
+            bucketQueuePop(state.closedDays);
+            changed = true;
+        }
+        else
+        {
+            retryInterval = BUCKET_RETRY_INTERVAL_MS;
+        }
+    }
+
+    if (changed)
+    {
+        saveRollupState(); // Written buckets must not be replayed after a power loss
+    }
+}
+/**************************************
+ *   Publish closed rollup buckets    *
+ *           end                      *
+ *************************************/
+
+void initHistoryRollups()
+{
+    if (state.magic != ROLLUP_STATE_MAGIC)
+    {
+        // Cold boot: RTC memory is garbage, fall back to the last checkpoint
+        Preferences prefs;
+        prefs.begin("rollup", true);
+        size_t bytes = prefs.getBytes("state", &state, sizeof(state));
+        prefs.end();
+
+        if (bytes != sizeof(state) || state.magic != ROLLUP_STATE_MAGIC ||
+            !bucketQueueValid(state.closedHours) || !bucketQueueValid(state.closedDays))
+        {
+            memset(&state, 0, sizeof(state));
+            state.magic = ROLLUP_STATE_MAGIC;
+            state.hour = -1;
+        }
+    }
+    lastSave = millis();
+}
+
+/**************************************
+ *   Fold in history rows             *
+ *           start                    *
+ *************************************/
+// Call every loop pass. Each new SampleHistory row is added to the open
+// hour and day buckets; bucket boundaries follow the local wall clock
+// like the energy rollups.
+void updateHistoryRollups()
+{
+    // Close buckets before adding, so a row lands in the bucket it belongs to
+    uint32_t dayKey;
+    int32_t hour;
+    if (bucketPeriodOf(timeClient.getEpochTime(), dayKey, hour))
+    {
+        if (state.hour < 0)
+        {
+            // First valid clock reading: the open buckets belong to now
+            state.dayKey = dayKey;
+            state.hour = hour;
+        }
+        else if (hour != state.hour || dayKey != state.dayKey)
+        {
+            if (state.hourBucket.samples > 0)
+            {
+                bucketQueuePush(state.closedHours, state.dayKey, state.hour, state.hourBucket);
+            }
+            clearBucket(state.hourBucket);
+            state.hour = hour;
+
+            if (dayKey != state.dayKey)
+            {
+                if (state.dayBucket.samples > 0)
+                {
+                    bucketQueuePush(state.closedDays, state.dayKey, -1, state.dayBucket);
+                }
+                clearBucket(state.dayBucket);
+                state.dayKey = dayKey;
+            }
+            saveRollupState();
+        }
+    }
+
+    HistorySample row;
+    if (getLatestHistorySample(row) && row.timestamp != lastRowTimestamp)
+    {
+        lastRowTimestamp = row.timestamp;
+        bool relayOn = isRelayCommandedOn();
+        addRow(state.hourBucket, row, relayOn);
+        addRow(state.dayBucket, row, relayOn);
+    }
+
+    if (millis() - lastSave >= ROLLUP_SAVE_INTERVAL)
+    {
+        saveRollupState();
+    }
+
+    if (state.closedHours.count > 0 || state.closedDays.count > 0)
+    {
+        publishPendingRollups();
+    }
+}
+/**************************************
+ *   Fold in history rows             *
+ *           end                      *
+ *************************************/
+
+const RollupBucket &getHourRollup()
+{
+    return state.hourBucket;
+}
+
+const RollupBucket &getDayRollup()
+{
+    return state.dayBucket;
+}
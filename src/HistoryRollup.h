@@ -0,0 +1,37 @@
+// ==================================================
+// File: src/HistoryRollup.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Hourly and daily min/max/mean per probe plus heater duty, built from
+// the SampleHistory rows and written once per closed bucket to
+//   ESP32/history/rollup/hourly/<YYYY-MM-DD>/<HH>
+//   ESP32/history/rollup/daily/<YYYY-MM-DD>
+// so long-range charts read one node per bucket instead of raw samples.
+#define ROLLUP_SAVE_INTERVAL 900000 // ms between NVS checkpoints inside an hour
+#define ROLLUP_PROBES 3             // Red, blue, green
+
+// One probe over one bucket, in centi-degrees like SampleHistory
+struct RollupChannel
+{
+    int16_t min;
+    int16_t max;
+    int32_t sum;
+    uint16_t count; // Valid samples; a day at 10 s is 8640
+};
+
+struct RollupBucket
+{
+    RollupChannel probe[ROLLUP_PROBES];
+    uint16_t samples;   // Rows seen, valid or not
+    uint16_t onSamples; // Rows taken with the relay on
+};
+
+// Function declarations
+void initHistoryRollups();   // Resumes the open buckets from RTC memory or NVS
+void updateHistoryRollups(); // loop(); folds in new history rows and writes closed buckets
+const RollupBucket &getHourRollup();
+const RollupBucket &getDayRollup();
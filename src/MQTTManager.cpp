@@ -15,6 +15,19 @@
 #include <ArduinoJson.h>
 #include "StatusLEDs.h"
 #include "FirebaseService.h" // For Firebase status publishing and sensor data persistence
+#include "ControlInput.h"
+#include "CurrentSampler.h"
+#include "HeaterClassifier.h"
+#include "ScheduleEngine.h"
+#include "ControlTask.h"
+#include "ReportByException.h"
+#include "ThermalPredictor.h"
+#include "AlertEngine.h"
+#include "SafetySupervisor.h"
+#include "FirebaseBatch.h"
+#include "HistoryOutbox.h"
+#include "HistoryRetention.h"
+#include "HistoryBlocks.h"
 // Firebase status publishing helper is now implemented in FirebaseService.cpp
 
 // Ensure status is available for LED updates
@@ -123,6 +136,74 @@ void onMQTTMessage(char *topic, unsigned char *payload, unsigned int length)
     {
         handleScheduleUpdate(topic, message);
     }
+    else if (topicStr.endsWith("control/inputpolicy"))
+    {
+        ControlCommand command = {CONTROL_CMD_INPUT_POLICY};
+        message.trim();
+        message.toLowerCase();
+        if (parseControlPolicy(message, command.policy))
+        {
+            postControlCommand(command);
+        }
+    }
+    else if (topicStr.endsWith("control/currentmode"))
+    {
+        message.trim();
+        message.toLowerCase();
+        if (message == "fundamental")
+        {
+            setCurrentAnalysisMode(CURRENT_MODE_FUNDAMENTAL);
+        }
+        else if (message == "rms")
+        {
+            setCurrentAnalysisMode(CURRENT_MODE_BROADBAND);
+        }
+    }
+    else if (topicStr.endsWith("control/heaterthresholds"))
+    {
+        bool accepted = setHeaterClassifierFromJson(message);
+        Serial.println(accepted ? "Heater threshold table updated" : "Heater threshold table rejected");
+    }
+    else if (topicStr.endsWith("control/mode"))
+    {
+        ControlCommand command = {CONTROL_CMD_MODE};
+        message.trim();
+        message.toLowerCase();
+        if (parseHeaterControlMode(message, command.mode))
+        {
+            postControlCommand(command);
+        }
+    }
+    else if (topicStr.endsWith("control/pituning"))
+    {
+        ControlCommand command = {CONTROL_CMD_PI_TUNING};
+        if (sscanf(message.c_str(), "%f,%f", &command.values[0], &command.values[1]) == 2)
+        {
+            postControlCommand(command);
+        }
+    }
+    else if (topicStr.endsWith("control/scheduleprofile"))
+    {
+        bool accepted = setScheduleFromJson(message);
+        Serial.println(accepted ? "Schedule profiles updated" : "Schedule profiles rejected");
+    }
+    else if (topicStr.endsWith("control/safetyreset"))
+    {
+        Serial.println("Safety cutout reset requested");
+        requestSafetyReset();
+    }
+    else if (topicStr.endsWith("control/historycleanup"))
+    {
+        requestHistoryRetention();
+    }
+    else if (topicStr.endsWith("control/inputweights"))
+    {
+        ControlCommand command = {CONTROL_CMD_INPUT_WEIGHTS};
+        if (sscanf(message.c_str(), "%f,%f,%f", &command.values[0], &command.values[1], &command.values[2]) == PROBE_ROLE_COUNT)
+        {
+            postControlCommand(command);
+        }
+    }
 }
 void initMQTT()
 {
@@ -179,6 +260,7 @@ void handleMQTT()
         if (connectToMQTT())
         {
             mqttStatus = MQTT_STATE_CONNECTED;
+            invalidateReports(REPORT_VIA_MQTT); // Subscribers may have missed values while we were away
         }
         else
         {
@@ -352,9 +434,6 @@ void publishSensorData()
     // Also push sensor data to Firebase for dashboard initialization
     pushSensorDataToFirebase(tempRed, tempBlue, tempGreen); // Publish dummy current data (until current sensor is implemented)
 
-    // Store historical data every 5 minutes for charting
-    storeHistoricalDataIfNeeded(tempRed, tempBlue, tempGreen);
-
     float dummyCurrent = random(0, 100) / 10.0; // Random current 0-10A
     publishSingleValue(TOPIC_CURRENT, dummyCurrent);
 
@@ -375,22 +454,24 @@ void publishSystemData()
 
     // Serial.println("Publishing system data to MQTT...");
 
-    static int prevRssi = INT_MIN;
+    // Each value goes out only on a meaningful change or heartbeat expiry
     int rssi = WiFi.RSSI();
-    if (rssi != prevRssi)
+    if (shouldReport(REPORT_WIFI_RSSI, rssi))
     {
         publishSingleValue(TOPIC_WIFI_RSSI, rssi);
-        prevRssi = rssi;
     }
 
     // Publish uptime in hours, minutes, and seconds
     unsigned long uptime = millis() / 1000;
-    unsigned long hours = uptime / 3600;
-    unsigned long minutes = (uptime % 3600) / 60;
-    unsigned long seconds = uptime % 60;
-    char uptimeStr[16];
-    snprintf(uptimeStr, sizeof(uptimeStr), "%02lu:%02lu:%02lu", hours, minutes, seconds);
-    publishSingleValue(TOPIC_UPTIME, uptimeStr);
+    if (shouldReport(REPORT_UPTIME, uptime))
+    {
+        unsigned long hours = uptime / 3600;
+        unsigned long minutes = (uptime % 3600) / 60;
+        unsigned long seconds = uptime % 60;
+        char uptimeStr[16];
+        snprintf(uptimeStr, sizeof(uptimeStr), "%02lu:%02lu:%02lu", hours, minutes, seconds);
+        publishSingleValue(TOPIC_UPTIME, uptimeStr);
+    }
 
     // Publish system status
     // publishSingleValue(TOPIC_STATUS, "online");
@@ -414,9 +495,265 @@ void publishSystemData()
     case BOTH_HEATERS_BLOWN:
         heaterStatus = "BOTH_BLOWN";
         break;
+    case HEATER_ENERGISED_WHEN_OFF:
+        heaterStatus = "ENERGISED_WHEN_OFF";
+        break;
     default:
         heaterStatus = "UNKNOWN";
         break;
     }
-    publishSingleValue("esp32/system/heater", heaterStatus);
+    if (shouldReport(REPORT_HEATER_STATE, status.heater))
+    {
+        publishSingleValue("esp32/system/heater", heaterStatus);
+    }
+}
+
+// Publish intervals of the diagnostic stats topics
+#define STATS_INTERVAL_FAST_MS 60000   // Sensor health, current spectrum, control task
+#define STATS_INTERVAL_SLOW_MS 300000  // Counters that move slowly
+#define STATS_INTERVAL_MODEL_MS 600000 // Thermal model fit
+
+// Shared gate of the stats publishers: true while the broker is down or
+// intervalMs has not passed since lastMs. Stamps lastMs when it lets a
+// publish through.
+static bool rateLimited(unsigned long &lastMs, unsigned long intervalMs)
+{
+    unsigned long now = millis();
+    if (mqttStatus != MQTT_STATE_CONNECTED || now - lastMs < intervalMs)
+    {
+        return true;
+    }
+    lastMs = now;
+    return false;
+}
+
+// Publishes one JSON object per probe, e.g.
+// {"Red":{"st":"OK","err":0.0,"dis":0,"crc":1,"por":0,"stk":0,"rty":3},...}
+// err is the % of failed cycles in the rolling window.
+void publishSensorHealth()
+{
+    static unsigned long lastHealthPublish = 0;
+    if (rateLimited(lastHealthPublish, STATS_INTERVAL_FAST_MS))
+    {
+        return;
+    }
+
+    char payload[480];
+    int len = snprintf(payload, sizeof(payload), "{");
+    for (int i = 0; i < getProbeCount() && len < (int)sizeof(payload); i++)
+    {
+        const ProbeEntry &probe = getProbe(i);
+        if (!probe.present)
+        {
+            continue;
+        }
+        const ProbeHealth &h = getProbeHealth(i);
+        len += snprintf(payload + len, sizeof(payload) - len,
+                        "%s\"%s\":{\"st\":\"%s\",\"err\":%.1f,\"dis\":%lu,\"crc\":%lu,\"por\":%lu,\"stk\":%lu,\"rty\":%lu}",
+                        len > 1 ? "," : "",
+                        probe.role == PROBE_ROLE_NONE ? String(i).c_str() : probeRoleToString(probe.role),
+                        probeFaultToString(h.lastFault),
+                        getProbeErrorRate(i),
+                        (unsigned long)h.faults[PROBE_FAULT_DISCONNECTED],
+                        (unsigned long)h.faults[PROBE_FAULT_CRC],
+                        (unsigned long)h.faults[PROBE_FAULT_POWER_ON_RESET],
+                        (unsigned long)h.faults[PROBE_FAULT_STUCK],
+                        (unsigned long)h.retries);
+    }
+    if (len < (int)sizeof(payload) - 1)
+    {
+        snprintf(payload + len, sizeof(payload) - len, "}");
+        publishSingleValue(TOPIC_SENSOR_HEALTH, payload);
+    }
+}
+
+// {"mode":"rms","rms":2.91,"f1":2.88,"h3":0.21,"h5":0.05,"thd":7.5}, amps
+void publishCurrentSpectrum()
+{
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    static unsigned long lastSpectrumPublish = 0;
+    if (rateLimited(lastSpectrumPublish, STATS_INTERVAL_FAST_MS))
+    {
+        return;
+    }
+
+    CurrentSpectrum spectrum = getCurrentSpectrum();
+    char payload[128];
+    snprintf(payload, sizeof(payload),
+             "{\"mode\":\"%s\",\"rms\":%.2f,\"f1\":%.2f,\"h3\":%.2f,\"h5\":%.2f,\"thd\":%.1f}",
+             currentAnalysisModeToString(getCurrentAnalysisMode()),
+             spectrum.totalRms, spectrum.fundamentalRms,
+             spectrum.harmonic3Rms, spectrum.harmonic5Rms, spectrum.thdPercent);
+    publishSingleValue(TOPIC_CURRENT_SPECTRUM, payload);
+#endif
+}
+
+// {"ticks":36000,"jit":112,"maxJit":2210,"exec":850,"wcet":14200,"over":0,"cmdDrop":0,"evtDrop":0}
+// Times in microseconds; jitter is the deviation of each wake-up interval
+// from CONTROL_TASK_PERIOD_MS.
+void publishControlTaskStats()
+{
+    static unsigned long lastStatsPublish = 0;
+    if (rateLimited(lastStatsPublish, STATS_INTERVAL_FAST_MS))
+    {
+        return;
+    }
+
+    ControlTaskStats stats = getControlTaskStats();
+    char payload[160];
+    snprintf(payload, sizeof(payload),
+             "{\"ticks\":%lu,\"jit\":%lu,\"maxJit\":%lu,\"exec\":%lu,\"wcet\":%lu,\"over\":%lu,\"cmdDrop\":%lu,\"evtDrop\":%lu}",
+             (unsigned long)stats.ticks, (unsigned long)stats.lastJitterUs, (unsigned long)stats.maxJitterUs,
+             (unsigned long)stats.lastExecUs, (unsigned long)stats.maxExecUs, (unsigned long)stats.overruns,
+             (unsigned long)stats.commandsDropped, (unsigned long)stats.eventsDropped);
+    publishSingleValue(TOPIC_CONTROL_TASK, payload);
+}
+
+// {"target":[12,3581],"targetFb":[2,3591],...}: [sent, suppressed] per
+// report-by-exception channel since boot
+void publishReportStats()
+{
+    static unsigned long lastReportStatsPublish = 0;
+    if (rateLimited(lastReportStatsPublish, STATS_INTERVAL_SLOW_MS))
+    {
+        return;
+    }
+
+    char payload[256];
+    size_t used = snprintf(payload, sizeof(payload), "{");
+    for (int i = 0; i < REPORT_CHANNEL_COUNT && used < sizeof(payload); i++)
+    {
+        ReportChannelStats stats = getReportChannelStats((ReportChannelId)i);
+        used += snprintf(payload + used, sizeof(payload) - used, "%s\"%s\":[%lu,%lu]",
+                         i ? "," : "", stats.name, (unsigned long)stats.sent, (unsigned long)stats.suppressed);
+    }
+    if (used < sizeof(payload) - 1)
+    {
+        strcat(payload, "}");
+        publishSingleValue(TOPIC_REPORT_STATS, payload);
+    }
+}
+
+// {"a":11.8,"b":0.612,"amb":18.4,"n":412,"ready":true}: heating rate at full
+// power (°C/h), loss rate (1/h) and ambient behind the pre-heat lead
+void publishThermalModel()
+{
+    static unsigned long lastThermalPublish = 0;
+    if (rateLimited(lastThermalPublish, STATS_INTERVAL_MODEL_MS))
+    {
+        return;
+    }
+
+    ThermalModelStatus model = getThermalModelStatus();
+    char payload[112];
+    snprintf(payload, sizeof(payload), "{\"a\":%.2f,\"b\":%.3f,\"amb\":%.1f,\"n\":%lu,\"ready\":%s}",
+             model.heatingRate, model.lossRate, isnan(model.ambient) ? 0.0f : model.ambient,
+             (unsigned long)model.samples, model.ready ? "true" : "false");
+    publishSingleValue(TOPIC_THERMAL_MODEL, payload);
+}
+
+// {"heater.single":[1,2,0],...}: [active, notifications, rate-limited] per
+// alert; notifications count since the alert was last raised
+void publishAlertStatus()
+{
+    static unsigned long lastAlertPublish = 0;
+    if (rateLimited(lastAlertPublish, STATS_INTERVAL_SLOW_MS))
+    {
+        return;
+    }
+
+    char payload[256];
+    size_t used = snprintf(payload, sizeof(payload), "{");
+    for (int i = 0; i < ALERT_COUNT && used < sizeof(payload); i++)
+    {
+        AlertStatus alert = getAlertStatus((AlertId)i);
+        used += snprintf(payload + used, sizeof(payload) - used, "%s\"%s\":[%d,%u,%lu]",
+                         i ? "," : "", alert.key, alert.active ? 1 : 0,
+                         (unsigned)alert.notifications, (unsigned long)alert.rateLimited);
+    }
+    if (used < sizeof(payload) - 1)
+    {
+        strcat(payload, "}");
+        publishSingleValue(TOPIC_ALERTS, payload);
+    }
+}
+
+// {"flush":720,"fail":1,"paths":5040,"coal":310,"drop":0,"ms":412,"maxMs":1830,"bytes":236,"maxBytes":402}
+// One flush is one updateNode PATCH carrying every dirty ESP32/control path
+void publishFirebaseBatchStats()
+{
+    static unsigned long lastBatchStatsPublish = 0;
+    if (rateLimited(lastBatchStatsPublish, STATS_INTERVAL_SLOW_MS))
+    {
+        return;
+    }
+
+    FirebaseBatchStats stats = getFirebaseBatchStats();
+    char payload[192];
+    snprintf(payload, sizeof(payload),
+             "{\"flush\":%lu,\"fail\":%lu,\"paths\":%lu,\"coal\":%lu,\"drop\":%lu,\"ms\":%lu,\"maxMs\":%lu,\"bytes\":%lu,\"maxBytes\":%lu}",
+             (unsigned long)stats.flushes, (unsigned long)stats.failures, (unsigned long)stats.pathsSent,
+             (unsigned long)stats.coalesced, (unsigned long)stats.dropped, (unsigned long)stats.lastLatencyMs,
+             (unsigned long)stats.maxLatencyMs, (unsigned long)stats.lastPayloadBytes, (unsigned long)stats.maxPayloadBytes);
+    publishSingleValue(TOPIC_FIREBASE_BATCH, payload);
+}
+
+// {"fs":true,"pending":0,"in":1440,"out":1440,"evict":0,"fail":3,"bad":0,"ms":640}
+void publishOutboxStats()
+{
+    static unsigned long lastOutboxPublish = 0;
+    if (rateLimited(lastOutboxPublish, STATS_INTERVAL_SLOW_MS))
+    {
+        return;
+    }
+
+    OutboxStats stats = getOutboxStats();
+    char payload[160];
+    snprintf(payload, sizeof(payload),
+             "{\"fs\":%s,\"pending\":%lu,\"in\":%lu,\"out\":%lu,\"evict\":%lu,\"fail\":%lu,\"bad\":%lu,\"ms\":%lu}",
+             stats.mounted ? "true" : "false", (unsigned long)stats.pending, (unsigned long)stats.appended,
+             (unsigned long)stats.delivered, (unsigned long)stats.evicted, (unsigned long)stats.failures,
+             (unsigned long)stats.corrupt, (unsigned long)stats.lastLatencyMs);
+    publishSingleValue(TOPIC_OUTBOX, payload);
+}
+
+// {"state":"IDLE","passes":3,"abandoned":0,"removed":1,"total":12,"ms":4210,"busyMs":930}
+// removed counts date nodes (whole days) deleted by the last completed pass
+void publishRetentionStats()
+{
+    static unsigned long lastRetentionPublish = 0;
+    if (rateLimited(lastRetentionPublish, STATS_INTERVAL_SLOW_MS))
+    {
+        return;
+    }
+
+    RetentionStats stats = getRetentionStats();
+    char payload[160];
+    snprintf(payload, sizeof(payload),
+             "{\"state\":\"%s\",\"passes\":%lu,\"abandoned\":%lu,\"removed\":%lu,\"total\":%lu,\"ms\":%lu,\"busyMs\":%lu}",
+             retentionStateToString(stats.state), (unsigned long)stats.passes, (unsigned long)stats.abandoned,
+             (unsigned long)stats.lastRemoved, (unsigned long)stats.totalRemoved,
+             (unsigned long)stats.lastDurationMs, (unsigned long)stats.lastBusyMs);
+    publishSingleValue(TOPIC_RETENTION, payload);
+}
+
+// {"written":24,"fail":0,"evict":0,"pending":0,"bytes":1210,"ms":520}
+void publishHistoryBlockStats()
+{
+#if HISTORY_BLOCK_MODE
+    static unsigned long lastBlockStatsPublish = 0;
+    if (rateLimited(lastBlockStatsPublish, STATS_INTERVAL_SLOW_MS))
+    {
+        return;
+    }
+
+    HistoryBlockStats stats = getHistoryBlockStats();
+    char payload[192];
+    snprintf(payload, sizeof(payload),
+             "{\"written\":%lu,\"fail\":%lu,\"evict\":%lu,\"bad\":%lu,\"pending\":%lu,\"bytes\":%lu,\"ms\":%lu,\"fs\":%s}",
+             (unsigned long)stats.written, (unsigned long)stats.failures, (unsigned long)stats.evicted,
+             (unsigned long)stats.corrupt, (unsigned long)stats.pending, (unsigned long)stats.lastBytes,
+             (unsigned long)stats.lastLatencyMs, stats.mounted ? "true" : "false");
+    publishSingleValue(TOPIC_HISTORY_BLOCKS, payload);
+#endif
 }
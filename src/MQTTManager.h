@@ -21,12 +21,27 @@
 #define TOPIC_TEMP_BLUE "esp32/sensors/temperature/blue"
 #define TOPIC_TEMP_GREEN "esp32/sensors/temperature/green"
 #define TOPIC_TARGET_TEMP "esp32/control/targetTemperature"
+#define TOPIC_CONTROL_INPUT "esp32/control/inputSource"
 #define TOPIC_CURRENT "esp32/sensors/current"
+#define TOPIC_SENSOR_HEALTH "esp32/sensors/health"
+#define TOPIC_CURRENT_SPECTRUM "esp32/sensors/current/spectrum"
+#define TOPIC_ENERGY_HOURLY "esp32/energy/hourly"
+#define TOPIC_ENERGY_DAILY "esp32/energy/daily"
 #define TOPIC_TIME "esp32/system/time"
 #define TOPIC_DATE "esp32/system/date"
 #define TOPIC_STATUS "esp32/system/status"
 #define TOPIC_WIFI_RSSI "esp32/system/wifi_rssi"
 #define TOPIC_UPTIME "esp32/system/uptime"
+#define TOPIC_REPORT_STATS "esp32/system/reporting"
+#define TOPIC_FIREBASE_BATCH "esp32/system/firebaseBatch"
+#define TOPIC_OUTBOX "esp32/system/historyOutbox"
+#define TOPIC_RETENTION "esp32/system/historyRetention"
+#define TOPIC_HISTORY_BLOCKS "esp32/system/historyBlocks"
+#define TOPIC_CONTROL_TASK "esp32/system/controlTask"
+#define TOPIC_THERMAL_MODEL "esp32/control/thermalModel"
+#define TOPIC_ALERTS "esp32/system/alerts"
+#define TOPIC_SAFETY "esp32/system/safety" // "OK" or latched faults, e.g. "OVER_TEMP,MAX_ON_TIME"
+#define TOPIC_RELAY_FAULT "esp32/system/relayFault" // "OK" | "LEAKAGE" | "ENERGISED_WHEN_OFF"
 
 // Control Topics (ESP32 subscribes to these)
 //#define TOPIC_CONTROL_SCHEDULE "React/control/schedule"
@@ -34,6 +49,15 @@
 #define TOPIC_CONTROL_PM_TEMP "React/control/schedule/pm/temperature"
 #define TOPIC_CONTROL_AM_TIME "React/control/schedule/am/time"
 #define TOPIC_CONTROL_PM_TIME "React/control/schedule/pm/time"
+#define TOPIC_CONTROL_INPUT_POLICY "React/control/inputPolicy"   // "primary" | "median" | "weighted"
+#define TOPIC_CONTROL_INPUT_WEIGHTS "React/control/inputWeights" // "red,blue,green" e.g. "1,0.5,0.5"
+#define TOPIC_CONTROL_CURRENT_MODE "React/control/currentMode"   // "rms" | "fundamental"
+#define TOPIC_CONTROL_MODE "React/control/mode"             // "hysteresis" | "pi"
+#define TOPIC_CONTROL_PI_TUNING "React/control/piTuning"   // "kp,integralTimeS" e.g. "0.5,1200"
+#define TOPIC_CONTROL_SCHEDULE_PROFILE "React/control/scheduleProfile" // JSON, see setScheduleFromJson()
+#define TOPIC_CONTROL_HEATER_THRESHOLDS "React/control/heaterThresholds" // JSON, see setHeaterClassifierFromJson()
+#define TOPIC_CONTROL_SAFETY_RESET "React/control/safetyReset" // Any payload clears latched safety faults
+#define TOPIC_CONTROL_HISTORY_CLEANUP "React/control/historyCleanup" // Any payload starts a retention pass
 //#define TOPIC_CONTROL_AM_ENABLED "React/control/schedule/am/enabled"
 //#define TOPIC_CONTROL_PM_ENABLED "React/control/schedule/pm/enabled"
 //#define TOPIC_CONTROL_PM_SCHEDULED_TIME "React/control/schedule/pm/scheduledTime"
@@ -54,6 +78,16 @@ void publishSingleValue(const char *topic, float value);
 void publishSingleValue(const char *topic, int value);
 void publishSingleValue(const char *topic, const char *value);
 bool checkTemperatureChanges(); // Check if any temperature sensor values have changed
+void publishSensorHealth();     // Compact per-probe health summary, rate limited internally
+void publishCurrentSpectrum();  // Fundamental and harmonic content, rate limited internally
+void publishControlTaskStats(); // Control task jitter and execution time, rate limited internally
+void publishReportStats();      // Sent/suppressed counts per report-by-exception channel, rate limited internally
+void publishThermalModel();     // Learned heating/loss rates behind pre-heat, rate limited internally
+void publishAlertStatus();      // Alert table state, rate limited internally
+void publishFirebaseBatchStats(); // Coalesced Firebase write counters, rate limited internally
+void publishOutboxStats();      // History store-and-forward backlog, rate limited internally
+void publishRetentionStats();   // History retention pass results, rate limited internally
+void publishHistoryBlockStats(); // Hourly history block writes, rate limited internally
 
 // Global MQTT status
 extern MQTTState mqttStatus;
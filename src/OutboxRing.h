@@ -0,0 +1,147 @@
+// ==================================================
+// File: src/OutboxRing.h
+// ==================================================
+// Record format and replay bookkeeping for the history outbox ring. Plain
+// C++ with no Arduino dependencies, so the ordering, eviction and replay
+// rules can be checked on a host (test/test_outbox).
+
+#pragma once
+#include <stdint.h>
+
+struct OutboxRing
+{
+    uint32_t capacity; // Slots
+    uint32_t head;     // Slot of the oldest record
+    uint32_t count;    // Records waiting
+};
+
+inline void outboxRingInit(OutboxRing &r, uint32_t capacity)
+{
+    r.capacity = capacity;
+    r.head = 0;
+    r.count = 0;
+}
+
+// Slot for a new record. When full the oldest record is evicted and
+// *evicted is set, so an outage longer than the ring keeps the newest data.
+inline uint32_t outboxRingPush(OutboxRing &r, bool *evicted)
+{
+    uint32_t slot = (r.head + r.count) % r.capacity;
+    if (r.count == r.capacity)
+    {
+        r.head = (r.head + 1) % r.capacity;
+        *evicted = true;
+    }
+    else
+    {
+        r.count++;
+        *evicted = false;
+    }
+    return slot;
+}
+
+// Slot of the i-th oldest record, i < count
+inline uint32_t outboxRingSlot(const OutboxRing &r, uint32_t i)
+{
+    return (r.head + i) % r.capacity;
+}
+
+// Drops the n oldest records once they have been delivered
+inline void outboxRingPop(OutboxRing &r, uint32_t n)
+{
+    if (n > r.count)
+    {
+        n = r.count;
+    }
+    r.head = (r.head + n) % r.capacity;
+    r.count -= n;
+}
+
+// A header read back from flash is only trusted if it is self-consistent
+inline bool outboxRingValid(const OutboxRing &r, uint32_t capacity)
+{
+    return r.capacity == capacity && r.head < capacity && r.count <= capacity;
+}
+
+// One stored sample. Centi-degrees as in SampleHistory; INT16_MIN for a
+// missing probe.
+struct OutboxRecord
+{
+    uint32_t epoch; // UTC seconds at acquisition
+    int16_t centi[3];
+    uint16_t check;
+};
+
+inline uint16_t outboxRecordCheck(const OutboxRecord &record)
+{
+    uint16_t check = 0xA5A5 ^ (uint16_t)record.epoch ^ (uint16_t)(record.epoch >> 16);
+    for (int i = 0; i < 3; i++)
+    {
+        check = (uint16_t)(check << 3 | check >> 13) ^ (uint16_t)record.centi[i];
+    }
+    return check;
+}
+
+// One replay batch, collected oldest first
+struct OutboxBatch
+{
+    uint32_t taken;       // Records consumed from the head of the ring
+    uint32_t sent;        // Of those, records added to the update
+    uint32_t corrupt;     // Of those, records skipped on a bad checksum
+    uint32_t newestEpoch; // Epoch of the newest record sent
+};
+
+// Walks up to maxRecords of the oldest records. read(slot, record) loads a
+// slot and returns false on an I/O error; add(record, index) appends a
+// record to the pending update and returns false once it is full. A torn
+// record is skipped rather than left to block the ring.
+template <typename ReadFn, typename AddFn>
+inline OutboxBatch outboxCollectBatch(const OutboxRing &r, uint32_t maxRecords, ReadFn read, AddFn add)
+{
+    OutboxBatch batch = {0, 0, 0, 0};
+    while (batch.taken < r.count && batch.taken < maxRecords)
+    {
+        OutboxRecord record;
+        if (!read(outboxRingSlot(r, batch.taken), record))
+        {
+            break;
+        }
+        if (record.check != outboxRecordCheck(record))
+        {
+            batch.corrupt++;
+            batch.taken++;
+            continue;
+        }
+        if (!add(record, batch.sent))
+        {
+            break;
+        }
+        batch.newestEpoch = record.epoch;
+        batch.taken++;
+        batch.sent++;
+    }
+    return batch;
+}
+
+// Drops a batch from the ring once its update was accepted; a batch of
+// only corrupt records needs no update. Returns true if the ring changed.
+inline bool outboxCompleteBatch(OutboxRing &r, const OutboxBatch &batch, bool delivered)
+{
+    if (batch.taken == 0 || (batch.sent > 0 && !delivered))
+    {
+        return false; // Records stay queued
+    }
+    outboxRingPop(r, batch.taken);
+    return true;
+}
+
+// Replay gap after an update: doubled while updates fail, back to the base
+// interval after a success
+inline uint32_t outboxNextInterval(uint32_t interval, bool delivered, uint32_t baseMs, uint32_t maxMs)
+{
+    if (delivered)
+    {
+        return baseMs;
+    }
+    return interval < maxMs ? interval * 2 : interval;
+}
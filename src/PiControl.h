@@ -0,0 +1,123 @@
+// ==================================================
+// File: src/PiControl.h
+// ==================================================
+// PI temperature control driving a slow time-proportioning relay window,
+// and the hysteresis rule it is selectable against. Plain C++ with no
+// Arduino dependencies, so it compiles on a host and can be run against a
+// simulated enclosure (test/test_control).
+
+#pragma once
+#include <stdint.h>
+
+#define HYSTERESIS_BAND 0.25f // °C; balanced for responsive control while preventing oscillation
+
+enum HeaterDemand
+{
+    DEMAND_OFF,
+    DEMAND_ON,
+    DEMAND_HOLD // Inside the hysteresis band
+};
+
+// Bang-bang: on below target, off above target + hysteresis
+inline HeaterDemand hysteresisDemand(float controlTemp, float target, float hysteresis)
+{
+    if (controlTemp > target + hysteresis)
+    {
+        return DEMAND_OFF;
+    }
+    if (controlTemp < target)
+    {
+        return DEMAND_ON;
+    }
+    return DEMAND_HOLD;
+}
+
+// PI on the temperature error, output is heater duty 0..1.
+// Anti-windup by conditional integration: the integral is frozen while the
+// output is saturated in the direction the error is pushing, and is itself
+// kept within the output range.
+struct PiController
+{
+    float kp;       // Duty per °C of error
+    float ki;       // Duty per °C·s of accumulated error (kp / integral time)
+    float integral; // Duty contributed by the I term
+};
+
+inline void piInit(PiController &pi, float kp, float integralTimeS)
+{
+    pi.kp = kp;
+    pi.ki = (integralTimeS > 0) ? kp / integralTimeS : 0.0f;
+    pi.integral = 0.0f;
+}
+
+inline float piClamp(float value, float lo, float hi)
+{
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+// error = target - measured, dtS = seconds since the previous update
+inline float piUpdate(PiController &pi, float error, float dtS)
+{
+    float unclamped = pi.kp * error + pi.integral;
+    bool saturatedHigh = unclamped >= 1.0f && error > 0;
+    bool saturatedLow = unclamped <= 0.0f && error < 0;
+    if (!saturatedHigh && !saturatedLow)
+    {
+        pi.integral = piClamp(pi.integral + pi.ki * error * dtS, 0.0f, 1.0f);
+    }
+    return piClamp(pi.kp * error + pi.integral, 0.0f, 1.0f);
+}
+
+// Turns a duty into relay on/off within a fixed window. The on-time is
+// taken at the start of each window so the relay switches at most twice
+// per window, and is rounded to 0 or the full window when it would break
+// the minimum on or off time.
+struct TimeProportioner
+{
+    uint32_t windowMs;
+    uint32_t minOnMs;
+    uint32_t minOffMs;
+    uint32_t windowStart;
+    uint32_t onTimeMs; // For the current window
+    bool started;
+};
+
+inline void tpInit(TimeProportioner &tp, uint32_t windowMs, uint32_t minOnMs, uint32_t minOffMs)
+{
+    tp.windowMs = windowMs;
+    tp.minOnMs = minOnMs;
+    tp.minOffMs = minOffMs;
+    tp.windowStart = 0;
+    tp.onTimeMs = 0;
+    tp.started = false;
+}
+
+inline uint32_t tpOnTime(const TimeProportioner &tp, float duty)
+{
+    uint32_t onTime = (uint32_t)(piClamp(duty, 0.0f, 1.0f) * tp.windowMs);
+    if (onTime < tp.minOnMs)
+    {
+        return 0;
+    }
+    if (tp.windowMs - onTime < tp.minOffMs)
+    {
+        return tp.windowMs;
+    }
+    return onTime;
+}
+
+// Returns whether the relay should be on at nowMs
+inline bool tpUpdate(TimeProportioner &tp, float duty, uint32_t nowMs)
+{
+    if (!tp.started || nowMs - tp.windowStart >= tp.windowMs)
+    {
+        tp.windowStart = tp.started ? tp.windowStart + tp.windowMs : nowMs;
+        if (nowMs - tp.windowStart >= tp.windowMs)
+        {
+            tp.windowStart = nowMs; // Updates stalled for more than a window
+        }
+        tp.onTimeMs = tpOnTime(tp, duty);
+        tp.started = true;
+    }
+    return nowMs - tp.windowStart < tp.onTimeMs;
+}
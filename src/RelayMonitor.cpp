@@ -0,0 +1,119 @@
+// ==================================================
+// File: src/RelayMonitor.cpp
+// ==================================================
+
+#include "RelayMonitor.h"
+#include "CurrentSampler.h"
+#include "HeaterClassifier.h"
+
+static uint32_t switchWindow = 0;
+static RelayFault reportedFault = RELAY_FAULT_NONE;
+static RelayFault candidateFault = RELAY_FAULT_NONE;
+static unsigned long candidateSince = 0;
+static uint32_t lastWindow = 0;
+static float offCurrent = 0;
+
+void noteRelaySwitched(bool on)
+{
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    switchWindow = getCurrentWindowCount();
+    setCurrentSamplerIdle(!on); // Full rate only while the heaters should draw
+#endif
+}
+
+bool isRelayCurrentSettled()
+{
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    // The window in progress at the switch may straddle it
+    return getCurrentWindowCount() - switchWindow >= RELAY_SETTLE_WINDOWS;
+#else
+    return true; // EmonLib samples on demand, after the switch
+#endif
+}
+
+// Classifies one off-state window; a latched ENERGISED verdict is only
+// dropped once the current falls below HEATER_OFF_THRESHOLD
+static RelayFault classifyOffCurrent(float current)
+{
+    float onThreshold = (reportedFault == RELAY_FAULT_ENERGISED_WHEN_OFF) ? HEATER_OFF_THRESHOLD : HEATER_ON_THRESHOLD;
+    if (current > onThreshold)
+    {
+        return RELAY_FAULT_ENERGISED_WHEN_OFF;
+    }
+    if (current > RELAY_LEAKAGE_THRESHOLD)
+    {
+        return RELAY_FAULT_LEAKAGE;
+    }
+    return RELAY_FAULT_NONE;
+}
+
+/**************************************
+ *   Commanded vs observed check      *
+ *           start                    *
+ *************************************/
+// Cheap enough for every pass: it only looks at the sampler's latest
+// window, and only when a new one has completed. While the relay is on the
+// heater current hides any contact fault, so the last verdict is held.
+RelayFault updateRelayMonitor(bool commandedOn)
+{
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    uint32_t window = getCurrentWindowCount();
+    if (commandedOn || !isRelayCurrentSettled() || window == lastWindow)
+    {
+        return reportedFault;
+    }
+    lastWindow = window;
+
+    CurrentSpectrum spectrum = getCurrentSpectrum();
+    offCurrent = spectrum.fundamentalRms - getCurrentBaseline(CURRENT_MODE_FUNDAMENTAL);
+    if (offCurrent < 0)
+    {
+        offCurrent = 0;
+    }
+
+    unsigned long now = millis();
+    RelayFault observed = classifyOffCurrent(offCurrent);
+    if (observed != candidateFault)
+    {
+        candidateFault = observed;
+        candidateSince = now;
+    }
+    if (candidateFault != reportedFault && now - candidateSince >= RELAY_FAULT_CONFIRM_MS)
+    {
+        reportedFault = candidateFault;
+#if DEBUG_SERIAL
+        Serial.print("Relay monitor: ");
+        Serial.print(relayFaultToString(reportedFault));
+        Serial.print(" (");
+        Serial.print(offCurrent, 2);
+        Serial.println(" A with relay OFF)");
+#endif
+    }
+#endif
+    return reportedFault;
+}
+/**************************************
+ *   Commanded vs observed check      *
+ *           end                      *
+ *************************************/
+
+RelayFault getRelayFault()
+{
+    return reportedFault;
+}
+
+float getRelayOffCurrent()
+{
+    return offCurrent;
+}
+
+const char *relayFaultToString(RelayFault fault)
+{
+    switch (fault)
+    {
+    case RELAY_FAULT_NONE:               return "OK";
+    case RELAY_FAULT_LEAKAGE:            return "LEAKAGE";
+    case RELAY_FAULT_ENERGISED_WHEN_OFF: return "ENERGISED_WHEN_OFF";
+    default:                             return "UNKNOWN";
+    }
+}
@@ -0,0 +1,29 @@
+// ==================================================
+// File: src/RelayMonitor.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Cross-checks the commanded relay state against the measured current.
+// Uses the mains-frequency component, which sits well clear of the ADC
+// noise floor, so small leakage currents are visible too.
+#define RELAY_LEAKAGE_THRESHOLD 0.15 // A above baseline with the relay off
+#define RELAY_FAULT_CONFIRM_MS 10000 // A new verdict must hold this long
+#define RELAY_SETTLE_WINDOWS 2       // Windows after a switch before the current is trusted
+
+enum RelayFault : uint8_t
+{
+    RELAY_FAULT_NONE,
+    RELAY_FAULT_LEAKAGE,           // Some current with the relay off
+    RELAY_FAULT_ENERGISED_WHEN_OFF // Heater current with the relay off (welded contact)
+};
+
+// Function declarations
+void noteRelaySwitched(bool on);   // Call on every commanded change
+bool isRelayCurrentSettled();      // Latest current window postdates the last switch
+RelayFault updateRelayMonitor(bool commandedOn);
+RelayFault getRelayFault();
+float getRelayOffCurrent();        // Latest current seen with the relay off, A above baseline
+const char *relayFaultToString(RelayFault fault);
@@ -0,0 +1,73 @@
+// ==================================================
+// File: src/ReportByException.cpp
+// ==================================================
+
+#include "ReportByException.h"
+
+struct ReportChannel
+{
+    const char *name;
+    ReportTransport transport;
+    float deadband;            // Minimum change worth reporting, in the value's units
+    unsigned long heartbeatMs; // Report at least this often
+    float lastValue;
+    unsigned long lastSent;
+    bool reported;             // false until the first report (or after invalidation)
+    uint32_t sent;
+    uint32_t suppressed;
+};
+
+// Indexed by ReportChannelId
+static ReportChannel channels[REPORT_CHANNEL_COUNT] = {
+    {"target", REPORT_VIA_MQTT, 0.05, 600000, 0, 0, false, 0, 0},      // °C, 10 min
+    {"targetFb", REPORT_VIA_FIREBASE, 0.05, 3600000, 0, 0, false, 0, 0}, // °C, 1 h
+    {"heater", REPORT_VIA_MQTT, 0.5, 300000, 0, 0, false, 0, 0},       // HeaterState, any change, 5 min
+    {"rssi", REPORT_VIA_MQTT, 3.0, 300000, 0, 0, false, 0, 0},         // dBm, 5 min
+    {"uptime", REPORT_VIA_MQTT, 60.0, 60000, 0, 0, false, 0, 0},       // s, once a minute
+};
+
+bool shouldReport(ReportChannelId id, float value)
+{
+    if (id >= REPORT_CHANNEL_COUNT)
+    {
+        return true;
+    }
+    ReportChannel &channel = channels[id];
+    unsigned long now = millis();
+    bool due = !channel.reported ||
+               fabs(value - channel.lastValue) >= channel.deadband ||
+               now - channel.lastSent >= channel.heartbeatMs;
+    if (!due)
+    {
+        channel.suppressed++;
+        return false;
+    }
+    channel.lastValue = value;
+    channel.lastSent = now;
+    channel.reported = true;
+    channel.sent++;
+    return true;
+}
+
+void invalidateReports(ReportTransport transport)
+{
+    for (int i = 0; i < REPORT_CHANNEL_COUNT; i++)
+    {
+        if (channels[i].transport == transport)
+        {
+            channels[i].reported = false;
+        }
+    }
+}
+
+ReportChannelStats getReportChannelStats(ReportChannelId id)
+{
+    ReportChannelStats stats = {"", 0, 0};
+    if (id < REPORT_CHANNEL_COUNT)
+    {
+        stats.name = channels[id].name;
+        stats.sent = channels[id].sent;
+        stats.suppressed = channels[id].suppressed;
+    }
+    return stats;
+}
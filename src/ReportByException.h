@@ -0,0 +1,38 @@
+// ==================================================
+// File: src/ReportByException.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+
+// Report-by-exception for periodically published values: a value goes
+// out when it has moved by at least its deadband since the last report,
+// or when its heartbeat interval has expired; every other call is
+// counted as suppressed.
+enum ReportChannelId : uint8_t
+{
+    REPORT_TARGET_MQTT,
+    REPORT_TARGET_FIREBASE,
+    REPORT_HEATER_STATE,
+    REPORT_WIFI_RSSI,
+    REPORT_UPTIME,
+    REPORT_CHANNEL_COUNT
+};
+
+enum ReportTransport : uint8_t
+{
+    REPORT_VIA_MQTT,
+    REPORT_VIA_FIREBASE
+};
+
+struct ReportChannelStats
+{
+    const char *name;
+    uint32_t sent;
+    uint32_t suppressed;
+};
+
+// Function declarations
+bool shouldReport(ReportChannelId id, float value); // true = publish now; counts the decision
+void invalidateReports(ReportTransport transport);  // Next call reports, e.g. after a reconnect
+ReportChannelStats getReportChannelStats(ReportChannelId id);
@@ -0,0 +1,168 @@
+// ==================================================
+// File: src/RingFile.cpp
+// ==================================================
+
+#include "RingFile.h"
+#include <LittleFS.h>
+
+#define RING_FILE_VERSION 1
+
+// Contents of the state file
+struct RingFileState
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    OutboxRing ring;
+};
+
+static uint32_t recordsPerSegment(const RingFile &file)
+{
+    return RING_FILE_SEGMENT_BYTES / file.recordSize;
+}
+
+static uint32_t segmentCount(const RingFile &file)
+{
+    uint32_t perSegment = recordsPerSegment(file);
+    return (file.capacity + perSegment - 1) / perSegment;
+}
+
+// The last segment only holds what is left of the capacity
+static size_t segmentBytes(const RingFile &file, uint32_t segment)
+{
+    uint32_t perSegment = recordsPerSegment(file);
+    uint32_t records = file.capacity - segment * perSegment;
+    return (size_t)(records < perSegment ? records : perSegment) * file.recordSize;
+}
+
+static void segmentPath(const RingFile &file, uint32_t segment, char *path)
+{
+    snprintf(path, RING_FILE_PATH_LEN, file.segmentFormat, (unsigned)segment);
+}
+
+// Opens the segment holding a slot and seeks to the slot
+static File openSlot(const RingFile &file, uint32_t slot, const char *mode)
+{
+    char path[RING_FILE_PATH_LEN];
+    segmentPath(file, slot / recordsPerSegment(file), path);
+    File segment = LittleFS.open(path, mode);
+    if (segment && !segment.seek((slot % recordsPerSegment(file)) * file.recordSize))
+    {
+        segment.close();
+        return File();
+    }
+    return segment;
+}
+
+// LittleFS only replaces the old contents when the file is closed, so a
+// power cut mid-write leaves the previous bookkeeping in place
+static bool saveState(const RingFile &file, const OutboxRing &ring)
+{
+    RingFileState state = {file.magic, RING_FILE_VERSION, file.recordSize, ring};
+    File stateFile = LittleFS.open(file.stateFile, "w");
+    if (!stateFile)
+    {
+        return false;
+    }
+    bool ok = stateFile.write((const uint8_t *)&state, sizeof(state)) == sizeof(state);
+    stateFile.close();
+    return ok;
+}
+
+// Pre-allocates every segment so writing a record never grows a file
+static bool createRing(RingFile &file)
+{
+    uint8_t zeros[256] = {};
+    for (uint32_t n = 0; n < segmentCount(file); n++)
+    {
+        char path[RING_FILE_PATH_LEN];
+        segmentPath(file, n, path);
+        File segment = LittleFS.open(path, "w", true);
+        if (!segment)
+        {
+            return false;
+        }
+        bool ok = true;
+        size_t remaining = segmentBytes(file, n);
+        while (ok && remaining > 0)
+        {
+            size_t chunk = remaining < sizeof(zeros) ? remaining : sizeof(zeros);
+            ok = segment.write(zeros, chunk) == chunk;
+            remaining -= chunk;
+        }
+        segment.close();
+        if (!ok)
+        {
+            return false;
+        }
+    }
+    outboxRingInit(file.ring, file.capacity);
+    return saveState(file, file.ring);
+}
+
+bool ringFileOpen(RingFile &file)
+{
+    RingFileState state;
+    bool valid = false;
+    File stateFile = LittleFS.open(file.stateFile, "r");
+    if (stateFile)
+    {
+        valid = stateFile.read((uint8_t *)&state, sizeof(state)) == sizeof(state) &&
+                state.magic == file.magic && state.version == RING_FILE_VERSION &&
+                state.recordSize == file.recordSize &&
+                outboxRingValid(state.ring, file.capacity);
+        stateFile.close();
+    }
+    for (uint32_t n = 0; valid && n < segmentCount(file); n++)
+    {
+        char path[RING_FILE_PATH_LEN];
+        segmentPath(file, n, path);
+        File segment = LittleFS.open(path, "r");
+        valid = segment && segment.size() == segmentBytes(file, n);
+        if (segment)
+        {
+            segment.close();
+        }
+    }
+
+    if (!valid)
+    {
+        return createRing(file);
+    }
+    file.ring = state.ring;
+    return true;
+}
+
+bool ringFileWrite(const RingFile &file, uint32_t slot, const void *record)
+{
+    File segment = openSlot(file, slot, "r+");
+    if (!segment)
+    {
+        return false;
+    }
+    bool ok = segment.write((const uint8_t *)record, file.recordSize) == file.recordSize;
+    segment.close();
+    return ok;
+}
+
+bool ringFileRead(const RingFile &file, uint32_t slot, void *record)
+{
+    File segment = openSlot(file, slot, "r");
+    if (!segment)
+    {
+        return false;
+    }
+    bool ok = segment.read((uint8_t *)record, file.recordSize) == file.recordSize;
+    segment.close();
+    return ok;
+}
+
+bool ringFileSave(RingFile &file, const OutboxRing &ring)
+{
+    if (!saveState(file, ring))
+    {
+        return false;
+    }
+    file.ring = ring;
+    return true;
+}
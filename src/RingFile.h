@@ -0,0 +1,34 @@
+// ==================================================
+// File: src/RingFile.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "OutboxRing.h"
+
+// Fixed-capacity ring of fixed-size records on LittleFS, shared by the
+// history outbox and the closed history blocks. LittleFS files are
+// copy-on-write: rewriting bytes inside a file rewrites that block and
+// every block after it. So the records are spread over segment files of at
+// most one flash block, and the ring bookkeeping (OutboxRing.h) lives in a
+// separate state file small enough to be stored inline in its directory
+// entry. Writing a record then rewrites one block, and saving the
+// bookkeeping is a metadata commit; neither touches the rest of the ring.
+#define RING_FILE_SEGMENT_BYTES 4096 // LittleFS block size on the ESP32
+#define RING_FILE_PATH_LEN 32
+
+struct RingFile
+{
+    const char *stateFile;
+    const char *segmentFormat; // printf pattern taking the segment number
+    uint32_t magic;
+    uint16_t recordSize;
+    uint32_t capacity;         // Records
+    OutboxRing ring;           // Bookkeeping as last saved
+};
+
+// Function declarations (LittleFS must be mounted)
+bool ringFileOpen(RingFile &file); // Loads the ring, or creates it empty if missing or inconsistent
+bool ringFileWrite(const RingFile &file, uint32_t slot, const void *record);
+bool ringFileRead(const RingFile &file, uint32_t slot, void *record);
+bool ringFileSave(RingFile &file, const OutboxRing &ring); // file.ring follows only on success
@@ -0,0 +1,90 @@
+// ==================================================
+// File: src/SafetyMath.h
+// ==================================================
+// Safety cutout checks. Plain C++ with no Arduino dependencies, so the
+// trip conditions can be exercised on a host.
+
+#pragma once
+#include <stdint.h>
+
+// Fault bits; once set a bit stays set until safetyReset()
+enum SafetyFault : uint8_t
+{
+    SAFETY_FAULT_NONE = 0,
+    SAFETY_FAULT_OVER_TEMP = 1 << 0,   // A probe reached maxTemp
+    SAFETY_FAULT_MAX_ON_TIME = 1 << 1, // Relay on continuously for longer than maxOnMs
+    SAFETY_FAULT_SENSOR_LOST = 1 << 2  // No valid reading from any probe for sensorTimeoutMs
+};
+
+struct SafetyLimits
+{
+    float maxTemp;
+    uint32_t maxOnMs;
+    uint32_t sensorTimeoutMs;
+};
+
+struct SafetyState
+{
+    uint8_t latched;     // SafetyFault bits
+    bool relayWasOn;
+    uint32_t onSinceMs;
+    uint32_t lastValidMs; // Last time any probe had a valid reading
+};
+
+inline void safetyInit(SafetyState &s, uint32_t nowMs)
+{
+    s.latched = SAFETY_FAULT_NONE;
+    s.relayWasOn = false;
+    s.onSinceMs = nowMs;
+    s.lastValidMs = nowMs; // Start-up counts as a fresh reading
+}
+
+// One supervisor pass. temps/valid hold the latest probe readings; the
+// caller passes valid[i] = false for readings it considers stale.
+// Returns the latched fault bits.
+inline uint8_t safetyEvaluate(SafetyState &s, const SafetyLimits &limits,
+                              const float *temps, const bool *valid, int count,
+                              bool relayOn, uint32_t nowMs)
+{
+    bool anyValid = false;
+    for (int i = 0; i < count; i++)
+    {
+        if (!valid[i])
+        {
+            continue;
+        }
+        anyValid = true;
+        if (temps[i] >= limits.maxTemp)
+        {
+            s.latched |= SAFETY_FAULT_OVER_TEMP;
+        }
+    }
+    if (anyValid)
+    {
+        s.lastValidMs = nowMs;
+    }
+    else if (nowMs - s.lastValidMs >= limits.sensorTimeoutMs)
+    {
+        s.latched |= SAFETY_FAULT_SENSOR_LOST;
+    }
+
+    if (relayOn && !s.relayWasOn)
+    {
+        s.onSinceMs = nowMs;
+    }
+    s.relayWasOn = relayOn;
+    if (relayOn && nowMs - s.onSinceMs >= limits.maxOnMs)
+    {
+        s.latched |= SAFETY_FAULT_MAX_ON_TIME;
+    }
+    return s.latched;
+}
+
+// Clears the latches; a condition that is still present trips again on
+// the next pass. The on-time and sensor timers restart.
+inline void safetyReset(SafetyState &s, uint32_t nowMs)
+{
+    s.latched = SAFETY_FAULT_NONE;
+    s.onSinceMs = nowMs;
+    s.lastValidMs = nowMs;
+}
@@ -0,0 +1,131 @@
+// ==================================================
+// File: src/SafetySupervisor.cpp
+// ==================================================
+
+#include "SafetySupervisor.h"
+#include "TemperatureSensors.h"
+#include "HeaterControl.h"
+#include <Preferences.h>
+
+static TaskHandle_t safetyTask = NULL;
+static SafetyState safety;
+static volatile uint8_t latchedFaults = SAFETY_FAULT_NONE; // Read lock-free by setRelay()
+static volatile bool resetRequested = false;
+
+static const SafetyLimits limits = {SAFETY_MAX_TEMP, SAFETY_MAX_ON_MS, SAFETY_SENSOR_TIMEOUT_MS};
+
+static void saveLatchedFaults(uint8_t faults)
+{
+    Preferences prefs;
+    prefs.begin("safety", false);
+    prefs.putUChar("faults", faults);
+    prefs.end();
+}
+
+/**************************************
+ *   Safety supervisor task           *
+ *           start                    *
+ *************************************/
+static void safetyTaskLoop(void *parameter)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SAFETY_TASK_PERIOD_MS));
+        uint32_t now = millis();
+
+        if (resetRequested)
+        {
+            resetRequested = false;
+            safetyReset(safety, now);
+            latchedFaults = SAFETY_FAULT_NONE;
+            saveLatchedFaults(SAFETY_FAULT_NONE);
+            Serial.println("Safety cutout reset");
+        }
+
+        // A snapshot that has stopped updating counts as no reading at all
+        SensorSnapshot snapshot = getSensorSnapshot();
+        bool fresh = snapshot.sequence > 0 && now - snapshot.timestamp < SAFETY_SENSOR_TIMEOUT_MS;
+        bool valid[MAX_PROBES];
+        for (int i = 0; i < MAX_PROBES; i++)
+        {
+            valid[i] = fresh && snapshot.valid[i] && !isnan(snapshot.temperature[i]);
+        }
+
+        uint8_t faults = safetyEvaluate(safety, limits, snapshot.temperature, valid, MAX_PROBES,
+                                        isRelayCommandedOn(), now);
+        if (faults != SAFETY_FAULT_NONE)
+        {
+            digitalWrite(RELAY_PIN, HIGH); // OFF, whatever the control task last did
+        }
+        if (faults != latchedFaults)
+        {
+            latchedFaults = faults;
+            saveLatchedFaults(faults); // Only on a new trip
+        }
+    }
+}
+/**************************************
+ *   Safety supervisor task           *
+ *           end                      *
+ *************************************/
+
+bool initSafetySupervisor()
+{
+    if (safetyTask != NULL)
+    {
+        return true;
+    }
+    safetyInit(safety, millis());
+
+    Preferences prefs;
+    prefs.begin("safety", true);
+    safety.latched = prefs.getUChar("faults", SAFETY_FAULT_NONE);
+    prefs.end();
+    latchedFaults = safety.latched;
+    if (safety.latched != SAFETY_FAULT_NONE)
+    {
+        digitalWrite(RELAY_PIN, HIGH);
+        char faults[48];
+        describeSafetyFaults(safety.latched, faults, sizeof(faults));
+        Serial.print("Safety cutout still latched from before reboot: ");
+        Serial.println(faults);
+    }
+
+    xTaskCreatePinnedToCore(safetyTaskLoop, "safety", SAFETY_TASK_STACK, NULL,
+                            SAFETY_TASK_PRIORITY, &safetyTask, SAFETY_TASK_CORE);
+    return safetyTask != NULL;
+}
+
+uint8_t getSafetyFaults()
+{
+    return latchedFaults;
+}
+
+bool isSafetyTripped()
+{
+    return latchedFaults != SAFETY_FAULT_NONE;
+}
+
+void requestSafetyReset()
+{
+    resetRequested = true;
+}
+
+void describeSafetyFaults(uint8_t faults, char *out, size_t len)
+{
+    if (faults == SAFETY_FAULT_NONE)
+    {
+        snprintf(out, len, "OK");
+        return;
+    }
+    snprintf(out, len, "%s%s%s",
+             (faults & SAFETY_FAULT_OVER_TEMP) ? "OVER_TEMP," : "",
+             (faults & SAFETY_FAULT_MAX_ON_TIME) ? "MAX_ON_TIME," : "",
+             (faults & SAFETY_FAULT_SENSOR_LOST) ? "SENSOR_LOST," : "");
+    size_t used = strlen(out);
+    if (used > 0 && out[used - 1] == ',')
+    {
+        out[used - 1] = '\0';
+    }
+}
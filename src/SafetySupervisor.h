@@ -0,0 +1,25 @@
+// ==================================================
+// File: src/SafetySupervisor.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "SafetyMath.h"
+
+// Over-temperature, maximum on-time and sensor-lost cutout. Runs in its own
+// task above the control task, reads only the sensor snapshot and the
+// commanded relay state, and forces the relay pin OFF itself while
+// tripped. setRelay() refuses to switch on while a fault is latched.
+// Latched faults survive a reboot and are cleared only by an explicit reset.
+#define SAFETY_TASK_PERIOD_MS 100
+#define SAFETY_TASK_PRIORITY 4 // Above the control task (3)
+#define SAFETY_TASK_CORE 1
+#define SAFETY_TASK_STACK 4096
+
+// Function declarations
+bool initSafetySupervisor(); // Restores latched faults from NVS and starts the task
+uint8_t getSafetyFaults();   // Latched SafetyFault bits
+bool isSafetyTripped();
+void requestSafetyReset();   // Applied on the supervisor's next pass
+void describeSafetyFaults(uint8_t faults, char *out, size_t len); // "OK" or e.g. "OVER_TEMP,SENSOR_LOST"
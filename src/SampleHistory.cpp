@@ -0,0 +1,119 @@
+// ==================================================
+// File: src/SampleHistory.cpp
+// ==================================================
+
+#include "SampleHistory.h"
+#include "Config.h"
+#include "TemperatureSensors.h"
+
+// Ring storage, one array per channel
+static uint32_t sampleTime[HISTORY_CAPACITY];
+static int16_t sampleValue[HISTORY_CHANNEL_COUNT][HISTORY_CAPACITY];
+static uint16_t head = 0;  // Next row to write
+static uint16_t count = 0; // Rows in use
+
+int16_t toCentiUnits(float value)
+{
+    if (isnan(value))
+    {
+        return HISTORY_INVALID;
+    }
+    float centi = roundf(value * 100.0f);
+    if (centi <= INT16_MIN || centi > INT16_MAX)
+    {
+        return HISTORY_INVALID; // Out of range for the fixed-point format
+    }
+    return (int16_t)centi;
+}
+
+float fromCentiUnits(int16_t value)
+{
+    return (value == HISTORY_INVALID) ? NAN : value / 100.0f;
+}
+
+// O(1): overwrites the oldest row once the buffer is full
+void appendHistorySample(uint32_t timestamp, const float values[HISTORY_CHANNEL_COUNT])
+{
+    sampleTime[head] = timestamp;
+    for (int c = 0; c < HISTORY_CHANNEL_COUNT; c++)
+    {
+        sampleValue[c][head] = toCentiUnits(values[c]);
+    }
+    head = (head + 1) % HISTORY_CAPACITY;
+    if (count < HISTORY_CAPACITY)
+    {
+        count++;
+    }
+}
+
+// Appends the latest sensor snapshot every HISTORY_SAMPLE_INTERVAL
+void recordSampleHistoryIfDue()
+{
+    static unsigned long lastSequence = 0;
+    static unsigned long lastAppend = 0;
+
+    SensorSnapshot snapshot = getSensorSnapshot();
+    if (snapshot.sequence == lastSequence)
+    {
+        return; // No new acquisition since the last row
+    }
+    if (count != 0 && snapshot.timestamp - lastAppend < HISTORY_SAMPLE_INTERVAL)
+    {
+        return;
+    }
+
+    float values[HISTORY_CHANNEL_COUNT];
+    values[HISTORY_RED] = getTemperature(PROBE_ROLE_RED);
+    values[HISTORY_BLUE] = getTemperature(PROBE_ROLE_BLUE);
+    values[HISTORY_GREEN] = getTemperature(PROBE_ROLE_GREEN);
+    values[HISTORY_CURRENT] = getLastCurrentReading();
+    appendHistorySample(snapshot.timestamp, values);
+
+    lastSequence = snapshot.sequence;
+    lastAppend = snapshot.timestamp;
+}
+
+uint16_t getHistoryCount()
+{
+    return count;
+}
+
+HistoryIterator historyBegin()
+{
+    return historyLast(count);
+}
+
+// Iterator over the newest rows, still visited oldest first
+HistoryIterator historyLast(uint16_t rows)
+{
+    if (rows > count)
+    {
+        rows = count;
+    }
+    HistoryIterator it;
+    it.position = (head + HISTORY_CAPACITY - rows) % HISTORY_CAPACITY;
+    it.remaining = rows;
+    return it;
+}
+
+bool historyNext(HistoryIterator &it, HistorySample &sample)
+{
+    if (it.remaining == 0)
+    {
+        return false;
+    }
+    sample.timestamp = sampleTime[it.position];
+    for (int c = 0; c < HISTORY_CHANNEL_COUNT; c++)
+    {
+        sample.value[c] = sampleValue[c][it.position];
+    }
+    it.position = (it.position + 1) % HISTORY_CAPACITY;
+    it.remaining--;
+    return true;
+}
+
+bool getLatestHistorySample(HistorySample &sample)
+{
+    HistoryIterator it = historyLast(1);
+    return historyNext(it, sample);
+}
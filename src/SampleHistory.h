@@ -0,0 +1,48 @@
+// ==================================================
+// File: src/SampleHistory.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+
+// Fixed-capacity in-memory history of sensor samples. Storage is static
+// struct-of-arrays in fixed point, so nothing here touches the heap.
+#define HISTORY_CAPACITY 360          // Rows kept (1 hour at the default interval)
+#define HISTORY_SAMPLE_INTERVAL 10000 // ms between rows
+#define HISTORY_INVALID INT16_MIN     // Stored for a missing value
+
+// Channels are probe roles followed by the heater current
+enum HistoryChannel
+{
+    HISTORY_RED = 0,
+    HISTORY_BLUE,
+    HISTORY_GREEN,
+    HISTORY_CURRENT,
+    HISTORY_CHANNEL_COUNT
+};
+
+// One row as returned by the iterator; values are centi-units
+// (0.01 °C for temperatures, 0.01 A for current)
+struct HistorySample
+{
+    uint32_t timestamp; // millis() when the values were acquired
+    int16_t value[HISTORY_CHANNEL_COUNT];
+};
+
+// Walks rows from oldest to newest
+struct HistoryIterator
+{
+    uint16_t position;  // Ring index of the next row
+    uint16_t remaining; // Rows left to visit
+};
+
+// Function declarations
+void appendHistorySample(uint32_t timestamp, const float values[HISTORY_CHANNEL_COUNT]);
+void recordSampleHistoryIfDue();
+uint16_t getHistoryCount();
+HistoryIterator historyBegin();
+HistoryIterator historyLast(uint16_t count);
+bool historyNext(HistoryIterator &it, HistorySample &sample);
+bool getLatestHistorySample(HistorySample &sample);
+int16_t toCentiUnits(float value);
+float fromCentiUnits(int16_t value);
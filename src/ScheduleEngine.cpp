@@ -0,0 +1,380 @@
+// ==================================================
+// File: src/ScheduleEngine.cpp
+// ==================================================
+
+#include "ScheduleEngine.h"
+#include <ArduinoJson.h>
+#include <Preferences.h>
+
+// Edited from loop() (MQTT, Firebase), read by the control task
+static ScheduleProfileData profiles[SCHEDULE_PROFILE_COUNT] = {};
+static portMUX_TYPE scheduleLock = portMUX_INITIALIZER_UNLOCKED;
+
+// AM/PM pair the profiles were last built from, so a cloud sync that
+// repeats it does not overwrite a full profile set over MQTT
+static Setpoint legacyPoints[2];
+static uint8_t legacyCount = 0;
+static bool legacyHasAm = false; // legacyPoints[0] is the AM setpoint
+
+// NVS image; bump the version when the layout changes
+#define SCHEDULE_STORE_VERSION 2
+struct StoredSchedule
+{
+    uint8_t version;
+    ScheduleProfileData profiles[SCHEDULE_PROFILE_COUNT];
+    Setpoint legacy[2];
+    uint8_t legacyCount;
+    uint8_t legacyHasAm; // Version 2; sits in what was tail padding, so a version 1 image is the same size
+};
+
+static void saveSchedule()
+{
+    StoredSchedule stored = {};
+    stored.version = SCHEDULE_STORE_VERSION;
+    stored.profiles[SCHEDULE_WEEKDAY] = getScheduleProfile(SCHEDULE_WEEKDAY);
+    stored.profiles[SCHEDULE_WEEKEND] = getScheduleProfile(SCHEDULE_WEEKEND);
+    memcpy(stored.legacy, legacyPoints, sizeof(legacyPoints));
+    stored.legacyCount = legacyCount;
+    stored.legacyHasAm = legacyHasAm;
+
+    Preferences prefs;
+    prefs.begin("schedule", false);
+    prefs.putBytes("profiles", &stored, sizeof(stored));
+    prefs.end();
+}
+
+// Puts the restored AM/PM pair back into currentSchedule, so a partial
+// cloud fetch or a single MQTT field merges with it instead of rebuilding
+// the profiles from that field alone
+static void seedLegacySchedule()
+{
+    uint8_t next = 0;
+    if (legacyHasAm && next < legacyCount)
+    {
+        const Setpoint &am = legacyPoints[next++];
+        currentSchedule.amTime = formatTime(am.minuteOfDay / 60, am.minuteOfDay % 60);
+        currentSchedule.amTemp = am.temperature;
+        currentSchedule.amHour = am.minuteOfDay / 60;
+        currentSchedule.amMinute = am.minuteOfDay % 60;
+    }
+    if (next < legacyCount)
+    {
+        const Setpoint &pm = legacyPoints[next];
+        currentSchedule.pmTime = formatTime(pm.minuteOfDay / 60, pm.minuteOfDay % 60);
+        currentSchedule.pmTemp = pm.temperature;
+        currentSchedule.pmHour = pm.minuteOfDay / 60;
+        currentSchedule.pmMinute = pm.minuteOfDay % 60;
+    }
+}
+
+void initScheduleEngine()
+{
+    StoredSchedule stored;
+    Preferences prefs;
+    prefs.begin("schedule", true);
+    size_t bytes = prefs.getBytes("profiles", &stored, sizeof(stored));
+    prefs.end();
+    if (bytes != sizeof(stored) || stored.version < 1 || stored.version > SCHEDULE_STORE_VERSION ||
+        stored.legacyCount > 2)
+    {
+        Serial.println("Schedule: nothing stored, waiting for the cloud");
+        return;
+    }
+
+    // Re-validated through the normal path, so a corrupt image is dropped
+    for (int p = 0; p < SCHEDULE_PROFILE_COUNT; p++)
+    {
+        const ScheduleProfileData &profile = stored.profiles[p];
+        if (profile.count > SCHEDULE_MAX_SETPOINTS ||
+            !setScheduleProfile((ScheduleProfile)p, profile.points, profile.count))
+        {
+            Serial.println("Schedule: stored profile rejected");
+        }
+    }
+    memcpy(legacyPoints, stored.legacy, sizeof(legacyPoints));
+    legacyCount = stored.legacyCount;
+    // Version 1 did not say which half a single setpoint was; a pair is AM then PM
+    legacyHasAm = stored.version >= 2 ? stored.legacyHasAm != 0 : legacyCount == 2;
+    if (stored.version < 2 && legacyCount == 1)
+    {
+        legacyCount = 0; // Unknown half: let the next cloud sync rebuild it
+    }
+    seedLegacySchedule();
+    Serial.print("Schedule restored: ");
+    Serial.print(stored.profiles[SCHEDULE_WEEKDAY].count);
+    Serial.print(" weekday, ");
+    Serial.print(stored.profiles[SCHEDULE_WEEKEND].count);
+    Serial.println(" weekend setpoints");
+}
+
+int parseMinuteOfDay(const char *hhmm)
+{
+    int hours, minutes;
+    char extra;
+    if (hhmm == NULL || sscanf(hhmm, "%d:%d%c", &hours, &minutes, &extra) != 2)
+    {
+        return -1;
+    }
+    if (hours < 0 || hours > 23 || minutes < 0 || minutes > 59)
+    {
+        return -1;
+    }
+    return hours * 60 + minutes;
+}
+
+// Copies, validates and sorts the setpoints into `updated`. A later
+// duplicate minute replaces an earlier one.
+static bool buildProfile(const Setpoint *points, uint8_t count, ScheduleProfileData &updated)
+{
+    if (count > SCHEDULE_MAX_SETPOINTS)
+    {
+        return false;
+    }
+
+    updated = {};
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (points[i].minuteOfDay >= MINUTES_PER_DAY || !isValidTemperature(points[i].temperature))
+        {
+            return false;
+        }
+        // Insertion sort; the lists are a handful of entries long
+        uint8_t pos = updated.count;
+        while (pos > 0 && updated.points[pos - 1].minuteOfDay > points[i].minuteOfDay)
+        {
+            pos--;
+        }
+        if (pos > 0 && updated.points[pos - 1].minuteOfDay == points[i].minuteOfDay)
+        {
+            updated.points[pos - 1].temperature = points[i].temperature;
+            continue;
+        }
+        memmove(&updated.points[pos + 1], &updated.points[pos], (updated.count - pos) * sizeof(Setpoint));
+        updated.points[pos] = points[i];
+        updated.count++;
+    }
+    return true;
+}
+
+bool setScheduleProfile(ScheduleProfile profile, const Setpoint *points, uint8_t count)
+{
+    ScheduleProfileData updated;
+    if (profile >= SCHEDULE_PROFILE_COUNT || !buildProfile(points, count, updated))
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&scheduleLock);
+    profiles[profile] = updated;
+    portEXIT_CRITICAL(&scheduleLock);
+    return true;
+}
+
+ScheduleProfileData getScheduleProfile(ScheduleProfile profile)
+{
+    portENTER_CRITICAL(&scheduleLock);
+    ScheduleProfileData copy = profiles[profile < SCHEDULE_PROFILE_COUNT ? profile : SCHEDULE_WEEKDAY];
+    portEXIT_CRITICAL(&scheduleLock);
+    return copy;
+}
+
+// Accepts e.g.
+// {"weekday":[{"t":"07:00","c":24.0},{"t":"19:30","c":20.0}],
+//  "weekend":[{"t":"08:30","c":24.0},{"t":"20:00","c":20.0}]}
+// Either key may be omitted; an empty list clears that profile.
+bool setScheduleFromJson(const String &json)
+{
+    JsonDocument doc;
+    if (deserializeJson(doc, json))
+    {
+        return false;
+    }
+
+    const char *keys[SCHEDULE_PROFILE_COUNT] = {"weekday", "weekend"};
+    Setpoint parsed[SCHEDULE_PROFILE_COUNT][SCHEDULE_MAX_SETPOINTS];
+    int counts[SCHEDULE_PROFILE_COUNT] = {-1, -1}; // -1 = key absent
+    for (int p = 0; p < SCHEDULE_PROFILE_COUNT; p++)
+    {
+        JsonArray list = doc[keys[p]].as<JsonArray>();
+        if (list.isNull())
+        {
+            continue;
+        }
+        counts[p] = 0;
+        for (JsonObject entry : list)
+        {
+            int minute = parseMinuteOfDay(entry["t"] | "");
+            if (counts[p] >= SCHEDULE_MAX_SETPOINTS || minute < 0)
+            {
+                return false;
+            }
+            parsed[p][counts[p]].minuteOfDay = minute;
+            parsed[p][counts[p]].temperature = entry["c"] | NAN;
+            counts[p]++;
+        }
+    }
+
+    // Validate both before changing either, then publish them together so
+    // the control task never sees one profile without the other
+    ScheduleProfileData updated[SCHEDULE_PROFILE_COUNT];
+    for (int p = 0; p < SCHEDULE_PROFILE_COUNT; p++)
+    {
+        if (counts[p] >= 0 && !buildProfile(parsed[p], counts[p], updated[p]))
+        {
+            return false;
+        }
+    }
+    portENTER_CRITICAL(&scheduleLock);
+    for (int p = 0; p < SCHEDULE_PROFILE_COUNT; p++)
+    {
+        if (counts[p] >= 0)
+        {
+            profiles[p] = updated[p];
+        }
+    }
+    portEXIT_CRITICAL(&scheduleLock);
+    saveSchedule();
+    return true;
+}
+
+// The dashboard still edits an AM and a PM setpoint; they become a
+// two-entry profile used every day. Ignored when nothing usable arrived or
+// the pair is the one already applied.
+void loadScheduleFromLegacy(const ScheduleData &legacy)
+{
+    Setpoint points[2];
+    uint8_t count = 0;
+    int amMinute = parseMinuteOfDay(legacy.amTime.c_str());
+    int pmMinute = parseMinuteOfDay(legacy.pmTime.c_str());
+    bool hasAm = amMinute >= 0 && isValidTemperature(legacy.amTemp);
+    if (hasAm)
+    {
+        points[count++] = {(uint16_t)amMinute, legacy.amTemp};
+    }
+    if (pmMinute >= 0 && isValidTemperature(legacy.pmTemp))
+    {
+        points[count++] = {(uint16_t)pmMinute, legacy.pmTemp};
+    }
+    bool unchanged = (count == legacyCount && hasAm == legacyHasAm);
+    for (uint8_t i = 0; unchanged && i < count; i++)
+    {
+        unchanged = points[i].minuteOfDay == legacyPoints[i].minuteOfDay &&
+                    points[i].temperature == legacyPoints[i].temperature;
+    }
+    if (count == 0 || unchanged)
+    {
+        return;
+    }
+
+    setScheduleProfile(SCHEDULE_WEEKDAY, points, count);
+    setScheduleProfile(SCHEDULE_WEEKEND, points, 0);
+    memcpy(legacyPoints, points, count * sizeof(Setpoint));
+    legacyCount = count;
+    legacyHasAm = hasAm;
+    saveSchedule();
+}
+
+// Binary search: index of the first setpoint later than minuteOfDay
+// (count when there is none)
+static int firstSetpointAfter(const ScheduleProfileData &profile, uint16_t minuteOfDay)
+{
+    int lo = 0;
+    int hi = profile.count;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (profile.points[mid].minuteOfDay <= minuteOfDay)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Caller holds scheduleLock
+static const ScheduleProfileData &profileForDay(int dayOfWeek)
+{
+    bool weekend = (dayOfWeek == 1 || dayOfWeek == 7); // TimeLib: 1 = Sunday
+    if (weekend && profiles[SCHEDULE_WEEKEND].count > 0)
+    {
+        return profiles[SCHEDULE_WEEKEND];
+    }
+    return profiles[SCHEDULE_WEEKDAY];
+}
+
+/**************************************
+ *   Active setpoint lookup           *
+ *           start                    *
+ *************************************/
+// Binary search for the last setpoint at or before the time of day. Before
+// the first setpoint of the day, the last one of the previous day still
+// applies. The answer depends only on the time given, so a reboot or a
+// missed minute cannot skip a transition.
+bool getActiveSetpoint(time_t localTime, Setpoint &active)
+{
+    int todayOfWeek = weekday(localTime);
+    int yesterdayOfWeek = weekday(localTime - SECS_PER_DAY);
+    uint16_t now = hour(localTime) * 60 + minute(localTime);
+
+    portENTER_CRITICAL(&scheduleLock);
+    ScheduleProfileData today = profileForDay(todayOfWeek);
+    ScheduleProfileData yesterday = profileForDay(yesterdayOfWeek);
+    portEXIT_CRITICAL(&scheduleLock);
+
+    int lo = firstSetpointAfter(today, now);
+    if (lo > 0)
+    {
+        active = today.points[lo - 1];
+        return true;
+    }
+
+    if (yesterday.count > 0)
+    {
+        active = yesterday.points[yesterday.count - 1];
+        return true;
+    }
+    if (today.count > 0)
+    {
+        active = today.points[today.count - 1]; // Nothing yesterday: wrap within today
+        return true;
+    }
+    return false;
+}
+/**************************************
+ *   Active setpoint lookup           *
+ *           end                      *
+ *************************************/
+
+// First setpoint after the given time: later today, else the first one of
+// tomorrow's profile
+bool getNextSetpoint(time_t localTime, Setpoint &next, uint32_t &secondsUntil)
+{
+    int todayOfWeek = weekday(localTime);
+    int tomorrowOfWeek = weekday(localTime + SECS_PER_DAY);
+    uint32_t nowSeconds = (hour(localTime) * 60 + minute(localTime)) * 60 + second(localTime);
+    uint16_t now = nowSeconds / 60;
+
+    portENTER_CRITICAL(&scheduleLock);
+    ScheduleProfileData today = profileForDay(todayOfWeek);
+    ScheduleProfileData tomorrow = profileForDay(tomorrowOfWeek);
+    portEXIT_CRITICAL(&scheduleLock);
+
+    int lo = firstSetpointAfter(today, now);
+    if (lo < today.count)
+    {
+        next = today.points[lo];
+        secondsUntil = next.minuteOfDay * 60UL - nowSeconds;
+        return true;
+    }
+    if (tomorrow.count > 0)
+    {
+        next = tomorrow.points[0];
+        secondsUntil = (MINUTES_PER_DAY + next.minuteOfDay) * 60UL - nowSeconds;
+        return true;
+    }
+    return false;
+}
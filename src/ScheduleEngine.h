@@ -0,0 +1,43 @@
+// ==================================================
+// File: src/ScheduleEngine.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include <TimeLib.h>
+#include "GetSchedule.h"
+
+// Target temperature as a function of local time. Each profile is a list
+// of setpoints sorted by minute of day; a setpoint stays active until the
+// next one, wrapping past midnight into the following day.
+#define SCHEDULE_MAX_SETPOINTS 8
+#define MINUTES_PER_DAY 1440
+
+enum ScheduleProfile : uint8_t
+{
+    SCHEDULE_WEEKDAY,
+    SCHEDULE_WEEKEND, // Saturday and Sunday; an empty weekend profile follows the weekday one
+    SCHEDULE_PROFILE_COUNT
+};
+
+struct Setpoint
+{
+    uint16_t minuteOfDay; // 0..1439
+    float temperature;    // °C
+};
+
+struct ScheduleProfileData
+{
+    uint8_t count;
+    Setpoint points[SCHEDULE_MAX_SETPOINTS]; // Ascending by minuteOfDay, no duplicates
+};
+
+// Function declarations
+void initScheduleEngine(); // Restores the last schedule from NVS; call before networking
+bool setScheduleProfile(ScheduleProfile profile, const Setpoint *points, uint8_t count);
+ScheduleProfileData getScheduleProfile(ScheduleProfile profile);
+bool setScheduleFromJson(const String &json);
+void loadScheduleFromLegacy(const ScheduleData &legacy); // AM/PM pair -> both profiles, if the pair changed
+bool getActiveSetpoint(time_t localTime, Setpoint &active);
+bool getNextSetpoint(time_t localTime, Setpoint &next, uint32_t &secondsUntil); // Within the next 24 h
+int parseMinuteOfDay(const char *hhmm); // "HH:MM" -> minute of day, -1 if invalid
@@ -11,7 +11,7 @@
  * Function to send an email       *
  *            start                 *
  ************************************/
-void sendEmail(const String &subject, const String &message)
+bool sendEmail(const String &subject, const String &message)
 {
     SMTPSession smtp;
     SMTP_Message msg;
@@ -46,7 +46,7 @@ void sendEmail(const String &subject, const String &message)
         if (!smtp.connect(&session))
         {
             Serial.println("Could not connect to mail server");
-            return;
+            return false;
         }
         else
         {
@@ -55,7 +55,7 @@ void sendEmail(const String &subject, const String &message)
             {
                 Serial.println("✅ Email sent successfully!");
                 smtp.closeSession();
-                return; // **SUCCESS! Exit the function immediately.**
+                return true; // **SUCCESS! Exit the function immediately.**
             }
             else
             {
@@ -75,6 +75,7 @@ void sendEmail(const String &subject, const String &message)
 
     // This code runs only if all attempts failed
     Serial.println("🛑 All attempts failed. Email NOT sent.");
+    return false;
 }
 /***************************************
  *  Function to send an email          *
@@ -3,7 +3,7 @@
 
 #include <Arduino.h>
 
-// Declare the sendEmail function
-void sendEmail(const String &subject, const String &message);
+// Declare the sendEmail function; returns false if the email was not sent
+bool sendEmail(const String &subject, const String &message);
 
 #endif // SEND_E_MAIL_H
\ No newline at end of file
@@ -0,0 +1,207 @@
+// ==================================================
+// File: src/SensorAcquisition.h
+// ==================================================
+// Non-blocking DS18B20 acquisition state machine, templated over the bus
+// so the same code runs against DallasTemperature on the device and a
+// simulated bus on the host. Plain C++ with no Arduino dependencies.
+
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// Capacity of the probe registry (probes on the bus plus remembered ROMs)
+#define MAX_PROBES 8
+
+// Fault classes. STUCK is a warning: the reading is still reported valid.
+enum ProbeFault : uint8_t
+{
+    PROBE_OK,
+    PROBE_FAULT_DISCONNECTED,   // No presence pulse or an all-0x00/0xFF scratchpad (-127 in the library)
+    PROBE_FAULT_CRC,            // Scratchpad CRC mismatch or an impossible value
+    PROBE_FAULT_POWER_ON_RESET, // 85 °C reset value: the probe browned out
+    PROBE_FAULT_STUCK,          // Same raw value for stuckCycleLimit() cycles while other probes moved
+    PROBE_FAULT_COUNT
+};
+
+// Identical raw readings before a probe converting at `bits` is flagged
+// stuck, given the limit at 12 bits. A 9-bit step is 8x a 12-bit one, so
+// a probe in a stable enclosure holds one coarse value far longer.
+inline uint32_t stuckCycleLimit(uint32_t limitAt12Bits, uint8_t bits)
+{
+    if (bits < 9 || bits > 12)
+    {
+        bits = 12;
+    }
+    return limitAt12Bits << (12 - bits);
+}
+
+// One acquisition cycle: a single bus conversion read back for every probe.
+// Arrays are indexed by registry slot; use getTemperature() for roles.
+struct SensorSnapshot
+{
+    float temperature[MAX_PROBES]; // °C, NAN if the probe did not answer
+    bool valid[MAX_PROBES];        // true if temperature[] holds a real reading
+    unsigned long timestamp;       // millis() when the conversion was read back
+    unsigned long sequence;        // incremented on every acquisition cycle
+};
+
+// Acquisition state machine (see acqStep())
+enum SensorAcqState
+{
+    SENSOR_ACQ_IDLE,       // Waiting for the next acquisition cycle
+    SENSOR_ACQ_CONVERTING, // Conversion started, waiting out the conversion time
+    SENSOR_ACQ_READY,      // Conversion done, reading probes back one per step
+    SENSOR_ACQ_ERROR       // Last cycle produced no valid probe
+};
+
+// Timing of the acquisition engine, for checking that no loop pass stalls
+struct SensorAcqStats
+{
+    unsigned long lastCycleMs; // Request to snapshot commit of the last cycle
+    unsigned long maxCycleMs;
+    unsigned long lastStepUs;  // Time spent inside the last updateTemperatureSensors() call
+    unsigned long maxStepUs;
+    unsigned long cycles;      // Completed acquisition cycles
+    unsigned long errorCycles; // Cycles where no probe answered
+    unsigned long lastConversionMs; // Conversion wait used by the last cycle
+    uint8_t lastResolution;         // Highest probe resolution in the last cycle
+    unsigned long resolutionChanges; // Resolution writes to probes
+};
+
+struct SensorAcquisition
+{
+    SensorAcqState state;
+    SensorAcqStats stats;
+    SensorSnapshot pending;      // Cycle in progress; handed to the bus once every probe is read
+    unsigned long intervalMs;    // Between conversion requests
+    uint8_t maxRetries;          // Extra scratchpad reads after a failed one
+    unsigned long conversionStart;
+    unsigned long conversionWaitMs;
+    int readIndex;
+    uint8_t readAttempts;
+};
+
+inline void acqInit(SensorAcquisition &acq, unsigned long intervalMs, uint8_t maxRetries)
+{
+    acq.state = SENSOR_ACQ_IDLE;
+    acq.stats = SensorAcqStats();
+    for (int i = 0; i < MAX_PROBES; i++)
+    {
+        acq.pending.temperature[i] = NAN;
+        acq.pending.valid[i] = false;
+    }
+    acq.pending.timestamp = 0;
+    acq.pending.sequence = 0;
+    acq.intervalMs = intervalMs;
+    acq.maxRetries = maxRetries;
+    acq.conversionStart = 0;
+    acq.conversionWaitMs = 0;
+    acq.readIndex = 0;
+    acq.readAttempts = 0;
+}
+
+// One step of the state machine; call on every loop pass. Each step does
+// at most one bus operation: start a conversion, read back a single probe
+// once the conversion time for the slowest probe has passed, or, between
+// cycles, one piece of housekeeping. It never waits on the bus.
+//
+// Bus provides:
+//   bool betweenCycles(unsigned long now)      one resolution write or rescan step; false if none due
+//   uint8_t conversionBits()                   resolution of the slowest present probe
+//   unsigned long startConversion(uint8_t bits) CONVERT T to every probe; returns the wait in ms
+//   int probeCount()
+//   bool probePresent(int slot)
+//   ProbeFault readProbe(int slot, float &temp)
+//   void probeRetried(int slot)
+//   void probeDone(int slot, ProbeFault fault) final result of the slot's cycle
+//   void commit(const SensorSnapshot &snapshot)
+template <typename Bus>
+inline void acqStep(SensorAcquisition &acq, Bus &bus, unsigned long now)
+{
+    switch (acq.state)
+    {
+    case SENSOR_ACQ_IDLE:
+    case SENSOR_ACQ_ERROR:
+        if (acq.stats.cycles != 0 && now - acq.conversionStart < acq.intervalMs)
+        {
+            bus.betweenCycles(now);
+            break;
+        }
+        acq.conversionStart = now;
+        acq.stats.lastResolution = bus.conversionBits();
+        acq.conversionWaitMs = bus.startConversion(acq.stats.lastResolution);
+        acq.stats.lastConversionMs = acq.conversionWaitMs;
+        acq.state = SENSOR_ACQ_CONVERTING;
+        break;
+
+    case SENSOR_ACQ_CONVERTING:
+        if (now - acq.conversionStart >= acq.conversionWaitMs)
+        {
+            acq.readIndex = 0;
+            acq.readAttempts = 0;
+            acq.state = SENSOR_ACQ_READY;
+        }
+        break;
+
+    case SENSOR_ACQ_READY:
+    {
+        int probeCount = bus.probeCount();
+        // Skip slots whose probe is not on the bus
+        while (acq.readIndex < probeCount && !bus.probePresent(acq.readIndex))
+        {
+            acq.pending.valid[acq.readIndex] = false;
+            acq.pending.temperature[acq.readIndex] = NAN;
+            acq.readIndex++;
+        }
+
+        if (acq.readIndex < probeCount)
+        {
+            float temp = NAN;
+            ProbeFault fault = bus.readProbe(acq.readIndex, temp);
+            bool retryable = (fault == PROBE_FAULT_DISCONNECTED || fault == PROBE_FAULT_CRC);
+
+            if (retryable && acq.readAttempts < acq.maxRetries)
+            {
+                // Read the same scratchpad again on the next step
+                acq.readAttempts++;
+                bus.probeRetried(acq.readIndex);
+            }
+            else
+            {
+                bool usable = (fault == PROBE_OK || fault == PROBE_FAULT_STUCK);
+                bus.probeDone(acq.readIndex, fault);
+                acq.pending.valid[acq.readIndex] = usable;
+                acq.pending.temperature[acq.readIndex] = usable ? temp : NAN;
+                acq.readAttempts = 0;
+                acq.readIndex++;
+            }
+        }
+
+        if (acq.readIndex >= probeCount)
+        {
+            bool anyValid = false;
+            for (int i = 0; i < probeCount; i++)
+            {
+                anyValid = anyValid || acq.pending.valid[i];
+            }
+
+            acq.pending.timestamp = now;
+            acq.pending.sequence++;
+            bus.commit(acq.pending);
+
+            acq.stats.lastCycleMs = now - acq.conversionStart;
+            if (acq.stats.lastCycleMs > acq.stats.maxCycleMs)
+            {
+                acq.stats.maxCycleMs = acq.stats.lastCycleMs;
+            }
+            acq.stats.cycles++;
+            if (!anyValid)
+            {
+                acq.stats.errorCycles++;
+            }
+            acq.state = anyValid ? SENSOR_ACQ_IDLE : SENSOR_ACQ_ERROR;
+        }
+        break;
+    }
+    }
+}
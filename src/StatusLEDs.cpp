@@ -84,6 +84,9 @@ void updateLEDs(SystemStatus &status)
     case BOTH_HEATERS_BLOWN:
         leds[LED_HEATER] = CRGB::Blue; // Both heaters blown - error
         break;
+    case HEATER_ENERGISED_WHEN_OFF:
+        leds[LED_HEATER] = CRGB::Purple; // Relay stuck closed - heaters cannot be switched off
+        break;
     }
 
     FastLED.show();
@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include "FirebaseBatch.h"
 #include <Firebase_ESP_Client.h>
 
 extern bool fbInitialized;
@@ -42,11 +43,11 @@ void publishAllSystemStatus(const SystemStatus &status)
     {
         mqttClient.publish("React/firebase/system/status", fbStatus, true);
     }
-    // Also update Firebase RTDB
+    // Also update Firebase RTDB (sent with the next batch flush)
     if (fbInitialized)
     {
-        Firebase.RTDB.setString(&fbData, "ESP32/control/wifi/wifi", wifiStatus);
-        Firebase.RTDB.setString(&fbData, "ESP32/control/mqtt", mqttStatus);
-        Firebase.RTDB.setString(&fbData, "ESP32/control/firebase", fbStatus);
+        queueFirebaseValue("wifi/wifi", wifiStatus);
+        queueFirebaseValue("mqtt", mqttStatus);
+        queueFirebaseValue("firebase", fbStatus);
     }
 }
@@ -3,91 +3,766 @@
 // ==================================================
 
 #include "TemperatureSensors.h"
+#include <Preferences.h>
 
 // Temperature sensor setup
 OneWire oneWire(DS18B20_PIN);
 DallasTemperature sensors(&oneWire);
 
-// Sensor addresses
-DeviceAddress red, blue, green;
+// Probe registry: ROM -> role, persisted in NVS under "probes"
+static ProbeEntry probes[MAX_PROBES];
+static int probeCount = 0;                       // Slots in use (present or remembered)
+static int8_t roleSlot[PROBE_ROLE_COUNT] = {-1, -1, -1}; // Role -> slot, -1 if unassigned
 static int connectedSensors = 0;
 
+// Incremental re-enumeration: one search step per call
+static bool seenThisPass[MAX_PROBES];
+static unsigned long lastRescan = 0;
+static bool rescanActive = false;
+static bool rescanRequested = false; // A probe stopped answering; rescan before the interval
+// Probes whose resolution write failed; left alone until a rescan completes
+// so a vanished probe cannot hold the bus ahead of the rescan
+static bool resolutionWriteFailed[MAX_PROBES];
+
+// Cached result of the last acquisition cycle, shared by every consumer.
+// Written by the control task; other tasks copy it under snapshotLock.
+static SensorSnapshot snapshot;
+static portMUX_TYPE snapshotLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Acquisition state machine (SensorAcquisition.h); holds the cycle in progress
+static SensorAcquisition acq;
+
+// Fault history per registry slot
+static ProbeHealth health[MAX_PROBES];
+
+// Layout of one record in the NVS blob
+struct StoredProbe
+{
+    uint8_t address[8];
+    uint8_t role;
+};
+
+static void printAddress(const DeviceAddress address)
+{
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        if (address[i] < 16)
+            Serial.print("0");
+        Serial.print(address[i], HEX);
+    }
+}
+
+/**************************************
+ *      Probe registry helpers        *
+ *           start                    *
+ *************************************/
+static void rebuildRoleIndex()
+{
+    for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+    {
+        roleSlot[r] = -1;
+    }
+    connectedSensors = 0;
+    for (int i = 0; i < probeCount; i++)
+    {
+        if (probes[i].role < PROBE_ROLE_COUNT)
+        {
+            roleSlot[probes[i].role] = i;
+        }
+        if (probes[i].present)
+        {
+            connectedSensors++;
+        }
+    }
+}
+
+static void saveProbeTable()
+{
+    StoredProbe table[MAX_PROBES];
+    for (int i = 0; i < probeCount; i++)
+    {
+        memcpy(table[i].address, probes[i].address, 8);
+        table[i].role = probes[i].role;
+    }
+
+    Preferences prefs;
+    prefs.begin("probes", false);
+    prefs.putBytes("map", table, probeCount * sizeof(StoredProbe));
+    prefs.end();
+}
+
+static void loadProbeTable()
+{
+    StoredProbe table[MAX_PROBES];
+    Preferences prefs;
+    prefs.begin("probes", true);
+    size_t bytes = prefs.getBytes("map", table, sizeof(table));
+    prefs.end();
+
+    probeCount = bytes / sizeof(StoredProbe);
+    for (int i = 0; i < probeCount; i++)
+    {
+        memcpy(probes[i].address, table[i].address, 8);
+        probes[i].role = (table[i].role < PROBE_ROLE_COUNT) ? (ProbeRole)table[i].role : PROBE_ROLE_NONE;
+        probes[i].present = false;
+        probes[i].missedPasses = 0;
+        probes[i].resolution = 0;
+        probes[i].desiredResolution = RESOLUTION_COARSE_BITS;
+    }
+}
+
+static int findProbe(const DeviceAddress address)
+{
+    for (int i = 0; i < probeCount; i++)
+    {
+        if (memcmp(probes[i].address, address, 8) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Registers a ROM seen on the bus; returns its slot or -1 if the table is full
+static int registerProbe(const DeviceAddress address)
+{
+    int slot = findProbe(address);
+    if (slot < 0)
+    {
+        if (probeCount < MAX_PROBES)
+        {
+            slot = probeCount++;
+        }
+        else
+        {
+            // Reuse a remembered slot that is absent and has no role
+            for (int i = 0; i < probeCount; i++)
+            {
+                if (!probes[i].present && probes[i].role == PROBE_ROLE_NONE)
+                {
+                    slot = i;
+                    break;
+                }
+            }
+            if (slot < 0)
+            {
+                return -1;
+            }
+        }
+        memcpy(probes[slot].address, address, 8);
+        probes[slot].role = PROBE_ROLE_NONE;
+        probes[slot].missedPasses = 0;
+        probes[slot].desiredResolution = RESOLUTION_COARSE_BITS;
+        memset(&health[slot], 0, sizeof(ProbeHealth));
+    }
+    if (!probes[slot].present)
+    {
+        // Newly attached probes power up with their EEPROM resolution
+        probes[slot].resolution = 0;
+    }
+    probes[slot].present = true;
+    return slot;
+}
+
+// End of an enumeration pass: drop probes that were not seen and hand any
+// role without a holder to unassigned probes, in role order. An absent
+// holder keeps its role (getTemperature() returns NAN for it, so the control
+// input falls back) until it has missed PROBE_ROLE_HANDOVER_PASSES passes in
+// a row; a single missed ROM search on a marginal bus must not move the
+// control role to a spare probe.
+static void reconcileProbeRoles(const bool seen[])
+{
+    bool changed = false;
+    for (int i = 0; i < probeCount; i++)
+    {
+        probes[i].present = seen[i];
+        if (seen[i])
+        {
+            probes[i].missedPasses = 0;
+        }
+        else if (probes[i].missedPasses < UINT8_MAX)
+        {
+            probes[i].missedPasses++;
+        }
+    }
+
+    for (int r = 0; r < PROBE_ROLE_COUNT; r++)
+    {
+        int holder = -1;
+        for (int i = 0; i < probeCount; i++)
+        {
+            if (probes[i].role == r)
+            {
+                holder = i;
+            }
+        }
+        if (holder >= 0 && (probes[holder].present ||
+                            probes[holder].missedPasses < PROBE_ROLE_HANDOVER_PASSES))
+        {
+            continue;
+        }
+        for (int i = 0; i < probeCount; i++)
+        {
+            if (probes[i].present && probes[i].role == PROBE_ROLE_NONE)
+            {
+                if (holder >= 0)
+                {
+                    // The long-absent holder gives the role up
+                    probes[holder].role = PROBE_ROLE_NONE;
+                }
+                probes[i].role = (ProbeRole)r;
+                changed = true;
+#if DEBUG_SERIAL
+                Serial.print("Probe ");
+                printAddress(probes[i].address);
+                Serial.print(" assigned role ");
+                Serial.println(probeRoleToString((ProbeRole)r));
+#endif
+                break;
+            }
+        }
+    }
+
+    rebuildRoleIndex();
+    if (changed)
+    {
+        saveProbeTable();
+    }
+}
+
+// One step of an incremental re-enumeration; a single ROM search per call
+static void rescanProbesStep()
+{
+    if (!rescanActive)
+    {
+        oneWire.reset_search();
+        for (int i = 0; i < MAX_PROBES; i++)
+        {
+            seenThisPass[i] = false;
+        }
+        rescanActive = true;
+    }
+
+    DeviceAddress address;
+    if (oneWire.search(address))
+    {
+        if (OneWire::crc8(address, 7) == address[7])
+        {
+            int slot = registerProbe(address);
+            if (slot >= 0)
+            {
+                seenThisPass[slot] = true;
+            }
+        }
+        return;
+    }
+
+    // Search exhausted: the pass is complete
+    rescanActive = false;
+    rescanRequested = false;
+    lastRescan = millis();
+    for (int i = 0; i < MAX_PROBES; i++)
+    {
+        resolutionWriteFailed[i] = false; // Probes still present get another try
+    }
+    reconcileProbeRoles(seenThisPass);
+}
+/**************************************
+ *      Probe registry helpers        *
+ *           end                      *
+ *************************************/
+
+/**************************************
+ *      Probe health helpers          *
+ *           start                    *
+ *************************************/
+// A flat reading only means a stuck probe if the rest of the bus saw the
+// temperature move meanwhile: true if another answering probe changed its
+// raw value within the last `cycles` cycles, or if there is no other
+// answering probe to compare with.
+static bool otherProbeMoved(int slot, uint16_t cycles)
+{
+    bool compared = false;
+    for (int i = 0; i < probeCount; i++)
+    {
+        const ProbeHealth &other = health[i];
+        if (i == slot || !probes[i].present || other.cycles == 0 ||
+            (other.lastFault != PROBE_OK && other.lastFault != PROBE_FAULT_STUCK))
+        {
+            continue;
+        }
+        if (other.sameRawCycles < cycles)
+        {
+            return true;
+        }
+        compared = true;
+    }
+    return !compared;
+}
+
+// Reads and classifies one probe's scratchpad. The raw value is decoded here
+// rather than through getTempC(), so a CRC error, a missing probe and the
+// 85 °C reset value can be told apart.
+static ProbeFault readProbe(int slot, float &temp)
+{
+    ScratchPad scratchPad;
+    if (!sensors.readScratchPad(probes[slot].address, scratchPad))
+    {
+        return PROBE_FAULT_DISCONNECTED;
+    }
+
+    bool allZero = true;
+    bool allOnes = true;
+    for (int i = 0; i < 9; i++)
+    {
+        allZero = allZero && scratchPad[i] == 0x00;
+        allOnes = allOnes && scratchPad[i] == 0xFF;
+    }
+    if (allZero || allOnes)
+    {
+        return PROBE_FAULT_DISCONNECTED;
+    }
+    if (OneWire::crc8(scratchPad, 8) != scratchPad[8])
+    {
+        return PROBE_FAULT_CRC;
+    }
+
+    // Drop the undefined low bits below the configured resolution
+    int16_t raw = (int16_t)((scratchPad[1] << 8) | scratchPad[0]);
+    uint8_t bits = ((scratchPad[4] >> 5) & 0x03) + 9;
+    raw &= ~((1 << (12 - bits)) - 1);
+    temp = raw * 0.0625f;
+
+    if (temp < -55.0f || temp > 125.0f)
+    {
+        return PROBE_FAULT_CRC;
+    }
+
+    // 85 °C is only believable if the probe was already reading close to it
+    ProbeHealth &h = health[slot];
+    if (raw == 0x0550 && !(snapshot.valid[slot] && fabs(snapshot.temperature[slot] - 85.0f) < 2.0f))
+    {
+        probes[slot].resolution = 0; // Reset also restored the EEPROM resolution
+        return PROBE_FAULT_POWER_ON_RESET;
+    }
+
+    if (raw == h.lastRaw)
+    {
+        if (h.sameRawCycles < UINT16_MAX)
+            h.sameRawCycles++;
+    }
+    else
+    {
+        h.sameRawCycles = 0;
+        h.lastRaw = raw;
+    }
+    bool stuck = h.sameRawCycles >= stuckCycleLimit(STUCK_CYCLE_LIMIT, bits) &&
+                 otherProbeMoved(slot, h.sameRawCycles);
+    return stuck ? PROBE_FAULT_STUCK : PROBE_OK;
+}
+
+// Books the final result of one probe's cycle into its history
+static void recordProbeResult(int slot, ProbeFault fault)
+{
+    ProbeHealth &h = health[slot];
+    bool failed = (fault != PROBE_OK && fault != PROBE_FAULT_STUCK);
+
+#if DEBUG_SERIAL
+    if (fault != h.lastFault)
+    {
+        Serial.print(probeRoleToString(probes[slot].role));
+        Serial.print(" probe health: ");
+        Serial.println(probeFaultToString(fault));
+    }
+#endif
+    // Count a stuck probe once, when it becomes stuck
+    if (fault != PROBE_FAULT_STUCK || h.lastFault != PROBE_FAULT_STUCK)
+    {
+        h.faults[fault]++;
+    }
+    h.lastFault = fault;
+    h.cycles++;
+    h.errorWindow = (h.errorWindow << 1) | (failed ? 1 : 0);
+}
+/**************************************
+ *      Probe health helpers          *
+ *           end                      *
+ *************************************/
+
+/**************************************
+ *      Probe resolution helpers      *
+ *           start                    *
+ *************************************/
+// Writes the configuration register to the scratchpad only. Unlike
+// DallasTemperature::setResolution() there is no copy to EEPROM, so the
+// frequent policy changes do not wear the probe, and there is no 20 ms delay.
+static bool writeProbeResolution(int slot, uint8_t bits)
+{
+    ScratchPad scratchPad;
+    if (!sensors.readScratchPad(probes[slot].address, scratchPad))
+    {
+        return false;
+    }
+
+    oneWire.reset();
+    oneWire.select(probes[slot].address);
+    oneWire.write(0x4E);          // WRITE SCRATCHPAD
+    oneWire.write(scratchPad[2]); // TH alarm register unchanged
+    oneWire.write(scratchPad[3]); // TL alarm register unchanged
+    oneWire.write(((bits - 9) << 5) | 0x1F);
+    oneWire.reset();
+
+#if DEBUG_SERIAL
+    Serial.print(probeRoleToString(probes[slot].role));
+    Serial.print(" probe resolution ");
+    Serial.print(probes[slot].resolution);
+    Serial.print(" -> ");
+    Serial.print(bits);
+    Serial.println(" bits");
+#endif
+    probes[slot].resolution = bits;
+    acq.stats.resolutionChanges++;
+    return true;
+}
+
+// Applies at most one pending resolution change; returns true if it used the bus.
+// A probe that does not take the write is skipped until the next rescan,
+// which is brought forward in case the probe has left the bus.
+static bool applyResolutionStep()
+{
+    for (int i = 0; i < probeCount; i++)
+    {
+        if (probes[i].present && !resolutionWriteFailed[i] &&
+            probes[i].resolution != probes[i].desiredResolution)
+        {
+            if (!writeProbeResolution(i, probes[i].desiredResolution))
+            {
+                probes[i].resolution = 0; // Unknown until the write succeeds
+                resolutionWriteFailed[i] = true;
+                rescanRequested = true;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Conversion time is set by the slowest probe on the bus
+static uint8_t highestProbeResolution()
+{
+    uint8_t bits = RESOLUTION_COARSE_BITS;
+    for (int i = 0; i < probeCount; i++)
+    {
+        if (!probes[i].present)
+        {
+            continue;
+        }
+        // Unknown resolution: assume the 12-bit power-on default
+        uint8_t probeBits = probes[i].resolution ? probes[i].resolution : RESOLUTION_FINE_BITS;
+        if (probeBits > bits)
+        {
+            bits = probeBits;
+        }
+    }
+    return bits;
+}
+/**************************************
+ *      Probe resolution helpers      *
+ *           end                      *
+ *************************************/
+
 void initTemperatureSensors()
 {
     sensors.begin();
-    connectedSensors = sensors.getDeviceCount();
+    sensors.setWaitForConversion(false); // requestTemperatures() returns immediately
 
-    // Get the addresses of the sensors
-    sensors.getAddress(red, 0);
-    sensors.getAddress(blue, 1);
-    sensors.getAddress(green, 2);
-    Serial.print("Connected Temperature Sensors: ");
-    Serial.println(connectedSensors);
-    Serial.print("Red Sensor Address: ");
-    for (uint8_t i = 0; i < 8; i++) {
-        if (red[i] < 16) Serial.print("0");
-        Serial.print(red[i], HEX);
+    for (int i = 0; i < MAX_PROBES; i++)
+    {
+        snapshot.temperature[i] = NAN;
+        snapshot.valid[i] = false;
     }
-    Serial.println();
+    snapshot.timestamp = 0;
+    snapshot.sequence = 0;
+    acqInit(acq, SENSOR_READ_INTERVAL, SENSOR_READ_RETRIES);
 
-    Serial.print("Blue Sensor Address: ");
-    for (uint8_t i = 0; i < 8; i++) {
-        if (blue[i] < 16) Serial.print("0");
-        Serial.print(blue[i], HEX);
-    }
-    Serial.println();
+    // Full enumeration at boot, then match ROMs against the stored table
+    loadProbeTable();
+    do
+    {
+        rescanProbesStep();
+    } while (rescanActive);
 
-    Serial.print("Green Sensor Address: ");
-    for (uint8_t i = 0; i < 8; i++) {
-        if (green[i] < 16) Serial.print("0");
-        Serial.print(green[i], HEX);
+    Serial.print("Connected Temperature Sensors: ");
+    Serial.println(connectedSensors);
+    for (int i = 0; i < probeCount; i++)
+    {
+        Serial.print(probeRoleToString(probes[i].role));
+        Serial.print(" Sensor Address: ");
+        printAddress(probes[i].address);
+        Serial.println(probes[i].present ? "" : " (absent)");
     }
-    Serial.println();
 }
 
 /**************************************
  * Get the temperature from a sensor  *
  *           start                    *
  *************************************/
+// sensorIndex is a ProbeRole (0 = red, 1 = blue, 2 = green). Returns the
+// cached value from the last acquisition cycle; no bus traffic.
 float getTemperature(int sensorIndex)
 {
-    DeviceAddress *sensorAddress;
-
-    // Select the appropriate sensor address
-    switch (sensorIndex)
-    {
-    case 0:
-        sensorAddress = &red;
-        break;
-    case 1:
-        sensorAddress = &blue;
-        break;
-    case 2:
-        sensorAddress = &green;
-        break;
-    default:
+    if (sensorIndex < 0 || sensorIndex >= PROBE_ROLE_COUNT)
+    {
         return NAN; // Invalid sensor index
     }
+    int slot = roleSlot[sensorIndex];
+    if (slot < 0)
+    {
+        return NAN; // No probe holds this role
+    }
+    portENTER_CRITICAL(&snapshotLock);
+    float temperature = snapshot.temperature[slot];
+    portEXIT_CRITICAL(&snapshotLock);
+    return temperature;
+}
+/**************************************
+ * Get the temperature from a sensor  *
+ *           end                      *
+ *************************************/
 
-    // Request temperature from specific sensor
-    sensors.requestTemperatures();
-    float temp = sensors.getTempC(*sensorAddress);
+/**************************************
+ *  Acquisition state machine         *
+ *           start                    *
+ *************************************/
+// DallasTemperature side of the state machine
+struct DallasBus
+{
+    // Between cycles: one pending resolution change, else one rescan step
+    bool betweenCycles(unsigned long now)
+    {
+        if (applyResolutionStep())
+        {
+            return true;
+        }
+        if (rescanActive || rescanRequested || now - lastRescan >= PROBE_RESCAN_INTERVAL)
+        {
+            rescanProbesStep();
+            return true;
+        }
+        return false;
+    }
+
+    uint8_t conversionBits()
+    {
+        return highestProbeResolution();
+    }
+
+    unsigned long startConversion(uint8_t bits)
+    {
+        sensors.requestTemperatures();
+        return sensors.millisToWaitForConversion(bits);
+    }
+
+    int probeCount()
+    {
+        return ::probeCount;
+    }
+
+    bool probePresent(int slot)
+    {
+        return probes[slot].present;
+    }
+
+    ProbeFault readProbe(int slot, float &temp)
+    {
+        return ::readProbe(slot, temp);
+    }
 
-    // Check if reading is valid
-    if (temp == DEVICE_DISCONNECTED_C)
+    void probeRetried(int slot)
     {
-        return NAN;
+        health[slot].retries++;
     }
 
-    return temp;
+    void probeDone(int slot, ProbeFault fault)
+    {
+        recordProbeResult(slot, fault);
+    }
+
+    void commit(const SensorSnapshot &cycle)
+    {
+        portENTER_CRITICAL(&snapshotLock);
+        snapshot = cycle;
+        portEXIT_CRITICAL(&snapshotLock);
+    }
+};
+
+// Call on every loop pass. Each call does at most one bus operation and
+// never waits on the bus; see acqStep().
+void updateTemperatureSensors()
+{
+    unsigned long stepStart = micros();
+    DallasBus bus;
+    acqStep(acq, bus, millis());
+
+    acq.stats.lastStepUs = micros() - stepStart;
+    if (acq.stats.lastStepUs > acq.stats.maxStepUs)
+    {
+        acq.stats.maxStepUs = acq.stats.lastStepUs;
+    }
 }
 /**************************************
- * Get the temperature from a sensor  *
+ *  Acquisition state machine         *
  *           end                      *
  *************************************/
 
-void readAllSensors()
+SensorAcqState getSensorAcqState()
 {
-    // Request temperatures from all sensors at once (more efficient)
-    sensors.requestTemperatures();
+    return acq.state;
+}
+
+const char *sensorAcqStateToString(SensorAcqState state)
+{
+    switch (state)
+    {
+    case SENSOR_ACQ_IDLE:       return "IDLE";
+    case SENSOR_ACQ_CONVERTING: return "CONVERTING";
+    case SENSOR_ACQ_READY:      return "READY";
+    case SENSOR_ACQ_ERROR:      return "ERROR";
+    default:                    return "UNKNOWN";
+    }
+}
+
+const SensorAcqStats &getSensorAcqStats()
+{
+    return acq.stats;
+}
+
+/**************************************
+ *  Per-probe resolution policy       *
+ *           start                    *
+ *************************************/
+// The control probe converts at 12 bits only while it is within
+// RESOLUTION_FINE_BAND of the setpoint; everything else runs at 9 bits.
+// Far from the setpoint, or with only ambient probes fine, a cycle takes
+// ~94 ms instead of ~750 ms. The change is written between cycles.
+void updateResolutionPolicy(float controlSetpoint)
+{
+    for (int i = 0; i < probeCount; i++)
+    {
+        uint8_t bits = RESOLUTION_COARSE_BITS;
+        if (probes[i].role == PROBE_ROLE_RED && !isnan(controlSetpoint) && snapshot.valid[i])
+        {
+            float distance = fabs(snapshot.temperature[i] - controlSetpoint);
+            float band = RESOLUTION_FINE_BAND;
+            if (probes[i].desiredResolution == RESOLUTION_FINE_BITS)
+            {
+                band += RESOLUTION_BAND_HYSTERESIS; // Don't flap at the band edge
+            }
+            if (distance <= band)
+            {
+                bits = RESOLUTION_FINE_BITS;
+            }
+        }
+        probes[i].desiredResolution = bits;
+    }
+}
+/**************************************
+ *  Per-probe resolution policy       *
+ *           end                      *
+ *************************************/
+
+const ProbeHealth &getProbeHealth(int slot)
+{
+    return health[slot];
+}
+
+float getProbeErrorRate(int slot)
+{
+    const ProbeHealth &h = health[slot];
+    uint32_t window = h.cycles < HEALTH_WINDOW_CYCLES ? h.cycles : HEALTH_WINDOW_CYCLES;
+    if (window == 0)
+    {
+        return 0.0;
+    }
+    uint64_t mask = (window >= 64) ? ~0ULL : ((1ULL << window) - 1);
+    return 100.0f * __builtin_popcountll(h.errorWindow & mask) / window;
+}
+
+const char *probeFaultToString(ProbeFault fault)
+{
+    switch (fault)
+    {
+    case PROBE_OK:                   return "OK";
+    case PROBE_FAULT_DISCONNECTED:   return "DISCONNECTED";
+    case PROBE_FAULT_CRC:            return "CRC";
+    case PROBE_FAULT_POWER_ON_RESET: return "POWER_ON_RESET";
+    case PROBE_FAULT_STUCK:          return "STUCK";
+    default:                         return "UNKNOWN";
+    }
+}
+
+// Returned by value so a reader on another task gets one consistent cycle
+SensorSnapshot getSensorSnapshot()
+{
+    portENTER_CRITICAL(&snapshotLock);
+    SensorSnapshot copy = snapshot;
+    portEXIT_CRITICAL(&snapshotLock);
+    return copy;
+}
+
+int getConnectedSensorCount()
+{
+    return connectedSensors;
+}
+
+int getProbeCount()
+{
+    return probeCount;
+}
+
+const ProbeEntry &getProbe(int slot)
+{
+    return probes[slot];
+}
+
+int getProbeSlotForRole(ProbeRole role)
+{
+    if (role >= PROBE_ROLE_COUNT)
+    {
+        return -1;
+    }
+    return roleSlot[role];
+}
+
+// Pins a role to a ROM (e.g. after swapping probes) and persists the table.
+// Passing PROBE_ROLE_NONE clears the ROM's role.
+bool assignProbeRole(const DeviceAddress address, ProbeRole role)
+{
+    int slot = findProbe(address);
+    if (slot < 0)
+    {
+        return false;
+    }
+    for (int i = 0; i < probeCount; i++)
+    {
+        if (role != PROBE_ROLE_NONE && probes[i].role == role)
+        {
+            probes[i].role = PROBE_ROLE_NONE;
+        }
+    }
+    probes[slot].role = role;
+    rebuildRoleIndex();
+    saveProbeTable();
+    return true;
+}
+
+const char *probeRoleToString(ProbeRole role)
+{
+    switch (role)
+    {
+    case PROBE_ROLE_RED:   return "Red";
+    case PROBE_ROLE_BLUE:  return "Blue";
+    case PROBE_ROLE_GREEN: return "Green";
+    default:               return "Unassigned";
+    }
 }
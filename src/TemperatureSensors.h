@@ -7,16 +7,82 @@
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #include "Config.h"
+#include "SensorAcquisition.h" // MAX_PROBES, ProbeFault, snapshot and acquisition state
+
+// How often the bus is re-enumerated for added or removed probes (ms)
+#define PROBE_RESCAN_INTERVAL 60000
+// Consecutive enumeration passes a role holder may miss before its role is
+// handed to another probe; until then the role is left unheld
+#define PROBE_ROLE_HANDOVER_PASSES 5
+
+// Resolution policy (see updateResolutionPolicy())
+#define RESOLUTION_COARSE_BITS 9      // 0.5 °C steps, 94 ms conversion
+#define RESOLUTION_FINE_BITS 12       // 0.0625 °C steps, 750 ms conversion
+#define RESOLUTION_FINE_BAND 1.0      // °C from setpoint where the control probe runs fine
+#define RESOLUTION_BAND_HYSTERESIS 0.25 // °C extra before dropping back to coarse
+
+// Health tracking (see readProbe())
+#define SENSOR_READ_RETRIES 2      // Extra scratchpad reads after a failed one
+#define STUCK_CYCLE_LIMIT 1800     // Identical raw readings at 12 bits before a probe is flagged stuck (see stuckCycleLimit())
+#define HEALTH_WINDOW_CYCLES 64    // Cycles covered by the rolling error rate
+
+// Per-probe fault history
+struct ProbeHealth
+{
+    ProbeFault lastFault;
+    uint32_t cycles;                    // Acquisition cycles this probe took part in
+    uint32_t faults[PROBE_FAULT_COUNT]; // Cycles ending in each class ([PROBE_OK] = good cycles)
+    uint32_t retries;                   // Extra scratchpad reads
+    uint64_t errorWindow;               // One bit per cycle, set if the cycle failed
+    int16_t lastRaw;
+    uint16_t sameRawCycles;
+};
+
+// Probe roles. getTemperature() takes a role, not a bus position.
+enum ProbeRole : uint8_t
+{
+    PROBE_ROLE_RED = 0, // Control probe
+    PROBE_ROLE_BLUE = 1,
+    PROBE_ROLE_GREEN = 2,
+    PROBE_ROLE_COUNT,
+    PROBE_ROLE_NONE = 0xFF // Known ROM without a role
+};
+
+// One registry slot. Slots keep their ROM while the probe is absent so the
+// role comes back with the probe.
+struct ProbeEntry
+{
+    DeviceAddress address;
+    ProbeRole role;
+    bool present;              // Seen on the last enumeration pass
+    uint8_t missedPasses;      // Consecutive enumeration passes without this probe
+    uint8_t resolution;        // Bits currently written to the probe, 0 if unknown
+    uint8_t desiredResolution; // Bits requested by the resolution policy
+};
 
 // Function declarations
 void initTemperatureSensors();
 float getTemperature(int sensorIndex);
-void readAllSensors();
+void updateTemperatureSensors();
 int getConnectedSensorCount();
+SensorSnapshot getSensorSnapshot();
+SensorAcqState getSensorAcqState();
+const char *sensorAcqStateToString(SensorAcqState state);
+const SensorAcqStats &getSensorAcqStats();
+void updateResolutionPolicy(float controlSetpoint);
+
+// Probe health
+const ProbeHealth &getProbeHealth(int slot);
+float getProbeErrorRate(int slot); // % of failed cycles over HEALTH_WINDOW_CYCLES
+const char *probeFaultToString(ProbeFault fault);
+
+// Probe registry
+int getProbeCount();
+const ProbeEntry &getProbe(int slot);
+int getProbeSlotForRole(ProbeRole role);
+bool assignProbeRole(const DeviceAddress address, ProbeRole role);
+const char *probeRoleToString(ProbeRole role);
 
 // External declarations for sensor objects
 extern OneWire oneWire;
 extern DallasTemperature sensors;
-extern DeviceAddress red, blue, green;
-
- // Pin for OneWire bus
@@ -0,0 +1,102 @@
+// ==================================================
+// File: src/ThermalMath.h
+// ==================================================
+// First-order enclosure model fitted online, and the pre-heat lead it
+// implies. Plain C++ with no Arduino dependencies, so it compiles on a
+// host and can be run against a simulated enclosure.
+
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+#define THERMAL_MAX_COVARIANCE 1e4f // Cap on the trace of P
+
+// dT/dt = a*u - b*(T - Tamb)
+//   u    heater duty over the sample interval (0..1)
+//   a    heating rate at full power, °C/h
+//   b    loss coefficient, 1/h (1/b is the cooling time constant)
+// Fitted by two-parameter recursive least squares with exponential
+// forgetting: fixed memory and O(1) work per sample.
+struct ThermalModel
+{
+    float a;
+    float b;
+    float p[2][2];   // Covariance
+    float lambda;    // Forgetting factor, e.g. 0.995
+    uint32_t samples;
+};
+
+inline void thermalInit(ThermalModel &m, float a, float b, float lambda)
+{
+    m.a = a;
+    m.b = b;
+    m.p[0][0] = 100.0f;
+    m.p[0][1] = 0.0f;
+    m.p[1][0] = 0.0f;
+    m.p[1][1] = 1.0f;
+    m.lambda = lambda;
+    m.samples = 0;
+}
+
+// rate = observed dT/dt (°C/h), duty = u, excess = mean (T - Tamb)
+inline void thermalUpdate(ThermalModel &m, float rate, float duty, float excess)
+{
+    float phi0 = duty;
+    float phi1 = -excess;
+
+    float pphi0 = m.p[0][0] * phi0 + m.p[0][1] * phi1;
+    float pphi1 = m.p[1][0] * phi0 + m.p[1][1] * phi1;
+    float denom = m.lambda + phi0 * pphi0 + phi1 * pphi1;
+    if (!(denom > 1e-6f))
+    {
+        return;
+    }
+    float k0 = pphi0 / denom;
+    float k1 = pphi1 / denom;
+
+    float error = rate - (m.a * phi0 + m.b * phi1);
+    m.a += k0 * error;
+    m.b += k1 * error;
+
+    // P = (P - k * phi' * P) / lambda, kept symmetric
+    float p00 = (m.p[0][0] - k0 * pphi0) / m.lambda;
+    float p01 = (m.p[0][1] - k0 * pphi1) / m.lambda;
+    float p11 = (m.p[1][1] - k1 * pphi1) / m.lambda;
+    // Without excitation (relay never switching) forgetting inflates P;
+    // scale it back to the cap so one odd sample cannot throw the
+    // estimate far off, while updates keep being applied and counted
+    float trace = p00 + p11;
+    if (trace > THERMAL_MAX_COVARIANCE)
+    {
+        float scale = THERMAL_MAX_COVARIANCE / trace;
+        p00 *= scale;
+        p01 *= scale;
+        p11 *= scale;
+    }
+    m.p[0][0] = p00;
+    m.p[0][1] = m.p[1][0] = p01;
+    m.p[1][1] = p11;
+    m.samples++;
+}
+
+// Seconds of full heating to go from `from` to `to` at ambient `ambient`,
+// or `maxSeconds` when the model says the target is out of reach
+inline uint32_t thermalLeadSeconds(const ThermalModel &m, float from, float to, float ambient, uint32_t maxSeconds)
+{
+    if (to <= from)
+    {
+        return 0;
+    }
+    if (!(m.a > 0) || !(m.b > 0))
+    {
+        return maxSeconds;
+    }
+    float ceiling = ambient + m.a / m.b; // Where full power levels off
+    if (to >= ceiling - 0.1f)
+    {
+        return maxSeconds;
+    }
+    float hours = logf((ceiling - from) / (ceiling - to)) / m.b;
+    float seconds = hours * 3600.0f;
+    return seconds >= maxSeconds ? maxSeconds : (uint32_t)seconds;
+}
@@ -0,0 +1,174 @@
+// ==================================================
+// File: src/ThermalPredictor.cpp
+// ==================================================
+
+#include "ThermalPredictor.h"
+#include "ThermalMath.h"
+#include "TemperatureSensors.h"
+#include <Preferences.h>
+
+// Written by the control task; loop() copies it under modelLock
+static ThermalModel model;
+static float ambient = NAN;
+static portMUX_TYPE modelLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Current sample interval
+static unsigned long sampleStart = 0;
+static float sampleStartTemp = NAN;
+static uint32_t decisions = 0;
+static uint32_t onDecisions = 0;
+
+struct StoredThermalModel
+{
+    float a;
+    float b;
+    uint32_t samples;
+};
+
+void initThermalPredictor()
+{
+    thermalInit(model, 10.0f, 0.5f, THERMAL_FORGETTING); // Rough 2x100 W guess
+
+    StoredThermalModel stored;
+    Preferences prefs;
+    prefs.begin("thermal", true);
+    size_t bytes = prefs.getBytes("model", &stored, sizeof(stored));
+    prefs.end();
+    if (bytes == sizeof(stored) && stored.a > 0 && stored.b > 0 && stored.a < 100 && stored.b < 10)
+    {
+        model.a = stored.a;
+        model.b = stored.b;
+        model.samples = stored.samples;
+        model.p[0][0] = 10.0f; // A stored fit is a better prior than the guess
+        model.p[1][1] = 0.1f;
+        Serial.print("Thermal model restored: a=");
+        Serial.print(model.a, 2);
+        Serial.print(" °C/h, b=");
+        Serial.print(model.b, 3);
+        Serial.println(" /h");
+    }
+}
+
+// Ambient is the mean of whichever of the blue/green probes is valid
+static float readAmbient()
+{
+    float sum = 0;
+    int count = 0;
+    const ProbeRole roles[2] = {PROBE_ROLE_BLUE, PROBE_ROLE_GREEN};
+    for (int i = 0; i < 2; i++)
+    {
+        float t = getTemperature(roles[i]);
+        if (!isnan(t))
+        {
+            sum += t;
+            count++;
+        }
+    }
+    return count ? sum / count : NAN;
+}
+
+/**************************************
+ *   Online model update              *
+ *           start                    *
+ *************************************/
+// Accumulates relay duty between samples; once per
+// THERMAL_SAMPLE_INTERVAL_MS feeds the observed rate of change to the RLS
+// fit. Any invalid reading restarts the interval.
+void updateThermalPredictor(float controlTemp, bool valid, bool relayOn)
+{
+    unsigned long now = millis();
+    float amb = readAmbient();
+    if (!valid || isnan(amb))
+    {
+        sampleStartTemp = NAN;
+        return;
+    }
+    if (isnan(sampleStartTemp))
+    {
+        sampleStart = now;
+        sampleStartTemp = controlTemp;
+        decisions = 0;
+        onDecisions = 0;
+        return;
+    }
+
+    decisions++;
+    if (relayOn)
+    {
+        onDecisions++;
+    }
+    if (now - sampleStart < THERMAL_SAMPLE_INTERVAL_MS)
+    {
+        return;
+    }
+
+    float hours = (now - sampleStart) / 3600000.0f;
+    float rate = (controlTemp - sampleStartTemp) / hours;
+    float duty = (float)onDecisions / decisions;
+    float excess = (controlTemp + sampleStartTemp) / 2.0f - amb;
+
+    portENTER_CRITICAL(&modelLock);
+    thermalUpdate(model, rate, duty, excess);
+    ambient = amb;
+    portEXIT_CRITICAL(&modelLock);
+
+    sampleStart = now;
+    sampleStartTemp = controlTemp;
+    decisions = 0;
+    onDecisions = 0;
+}
+/**************************************
+ *   Online model update              *
+ *           end                      *
+ *************************************/
+
+ThermalModelStatus getThermalModelStatus()
+{
+    portENTER_CRITICAL(&modelLock);
+    ThermalModelStatus status = {model.a, model.b, ambient, model.samples, false};
+    portEXIT_CRITICAL(&modelLock);
+    status.ready = status.samples >= THERMAL_MIN_SAMPLES && status.heatingRate > 0 &&
+                   status.lossRate > 0 && !isnan(status.ambient);
+    return status;
+}
+
+bool isThermalModelReady()
+{
+    return getThermalModelStatus().ready;
+}
+
+uint32_t getPreheatLeadSeconds(float from, float to)
+{
+    ThermalModelStatus status = getThermalModelStatus();
+    if (!status.ready)
+    {
+        return 0;
+    }
+    ThermalModel fit = {};
+    fit.a = status.heatingRate;
+    fit.b = status.lossRate;
+    uint32_t lead = thermalLeadSeconds(fit, from, to, status.ambient, PREHEAT_MAX_LEAD_S);
+    lead = (uint32_t)(lead * PREHEAT_MARGIN);
+    return lead > PREHEAT_MAX_LEAD_S ? PREHEAT_MAX_LEAD_S : lead;
+}
+
+void checkpointThermalModel()
+{
+    static unsigned long lastSave = 0;
+    if (millis() - lastSave < THERMAL_SAVE_INTERVAL)
+    {
+        return;
+    }
+    lastSave = millis();
+
+    ThermalModelStatus status = getThermalModelStatus();
+    if (!status.ready)
+    {
+        return;
+    }
+    StoredThermalModel stored = {status.heatingRate, status.lossRate, status.samples};
+    Preferences prefs;
+    prefs.begin("thermal", false);
+    prefs.putBytes("model", &stored, sizeof(stored));
+    prefs.end();
+}
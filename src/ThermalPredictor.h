@@ -0,0 +1,34 @@
+// ==================================================
+// File: src/ThermalPredictor.h
+// ==================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// Learns how fast the enclosure heats and cools (see ThermalMath.h) and
+// turns that into a pre-heat lead, so a higher setpoint is reached at its
+// scheduled time rather than tens of minutes after it.
+#define THERMAL_SAMPLE_INTERVAL_MS 60000 // One model update per minute
+#define THERMAL_FORGETTING 0.995         // Effective memory ~200 samples (~3 h)
+#define THERMAL_MIN_SAMPLES 120          // Samples before the model is trusted
+#define THERMAL_SAVE_INTERVAL 3600000    // ms between NVS checkpoints
+#define PREHEAT_MAX_LEAD_S 7200          // Never start more than 2 h early
+#define PREHEAT_MARGIN 1.15              // Lead safety factor
+
+struct ThermalModelStatus
+{
+    float heatingRate; // a, °C/h at full power
+    float lossRate;    // b, 1/h
+    float ambient;     // °C, NAN when unknown
+    uint32_t samples;
+    bool ready;
+};
+
+// Function declarations
+void initThermalPredictor();    // Restores the last fit from NVS
+void updateThermalPredictor(float controlTemp, bool valid, bool relayOn); // Control task, every decision
+bool isThermalModelReady();
+uint32_t getPreheatLeadSeconds(float from, float to); // 0 when the model is not ready
+ThermalModelStatus getThermalModelStatus();
+void checkpointThermalModel();  // loop(); writes NVS at most every THERMAL_SAVE_INTERVAL
@@ -34,6 +34,7 @@ WiFiUDP ntpUDP;
 const int UTC_OFFSET_STANDARD_VALUE = 0 * 3600;
 const int UTC_OFFSET_DST_VALUE = 1 * 3600;
 NTPClient timeClient(ntpUDP, "pool.ntp.org", UTC_OFFSET_STANDARD_VALUE, 60000);
+static int currentUtcOffset = UTC_OFFSET_STANDARD_VALUE; // Offset last applied by getTime()
 
 bool isDST(int day, int month, int hour)
 {
@@ -72,6 +73,7 @@ void getTime()
     bool dstActive = isDST(tempDay, tempMonth, tempHour);
     int offset = dstActive ? UTC_OFFSET_DST_VALUE : UTC_OFFSET_STANDARD_VALUE;
     timeClient.setTimeOffset(offset);
+    currentUtcOffset = offset;
     timeClient.update();
     epochTime = timeClient.getEpochTime();
 
@@ -152,3 +154,15 @@ String getFormattedDate()
     sprintf(dateBuffer, "%d/%d/%d", currentDay, currentMonth, year(epochTime));
     return String(dateBuffer);
 }
+
+// The NTP client runs on local time and the system clock is never set, so
+// UTC for history keys is derived here
+bool getUtcEpoch(time_t &utc)
+{
+    if (!timeClient.isTimeSet())
+    {
+        return false;
+    }
+    utc = timeClient.getEpochTime() - currentUtcOffset;
+    return true;
+}
@@ -56,5 +56,6 @@ void storeDateToFirebase();
 void handleTimeManager();
 String getFormattedTime();
 String getFormattedDate();
+bool getUtcEpoch(time_t &utc); // false until NTP has answered
 
 #endif // TIMEMANAGER_H
@@ -12,6 +12,21 @@ static int prevFirebase = -1;
 #include "TimeManager.h"
 #include "HeaterControl.h"
 #include "MQTTManager.h"
+#include "SampleHistory.h"
+#include "CurrentSampler.h"
+#include "EnergyMeter.h"
+#include "HeaterClassifier.h"
+#include "RelayMonitor.h"
+#include "ControlTask.h"
+#include "ScheduleEngine.h"
+#include "ThermalPredictor.h"
+#include "AlertEngine.h"
+#include "SafetySupervisor.h"
+#include "FirebaseBatch.h"
+#include "HistoryOutbox.h"
+#include "HistoryRetention.h"
+#include "HistoryRollup.h"
+#include "HistoryBlocks.h"
 #ifndef LED_BUILTIN
 #define LED_BUILTIN 2 // Most ESP32 boards use GPIO2 for the onboard LED
 #endif
@@ -26,14 +41,42 @@ void setup()
 {
 
   Serial.begin(115200);
-  delay(1000); // Wait a moment before proceeding
 
   pinMode(LED_BUILTIN, OUTPUT);  // Initialize the BUILTIN_LED pin as an output
   pinMode(RELAY_PIN, OUTPUT);    // Initialize the RELAY_PIN as an output
   digitalWrite(RELAY_PIN, HIGH); // Relay OFF (HIGH = OFF for active-low relay)
-  delay(1000);                   // Wait a moment to ensure LEDs are ready
+
+  /*************************************
+   * Local control first: everything   *
+   * it needs comes from NVS, so the   *
+   * heater is controlled while WiFi,  *
+   * NTP and Firebase come up          *
+   *     start                         *
+   ************************************/
+  initSafetySupervisor();   // Latched safety faults from NVS; cutout running from here on
+  initScheduleEngine();     // Last schedule from NVS
+  initHeaterControl();      // Last target, mode and PI state from NVS
+  initTemperatureSensors(); // Initialize Temperature Sensors
+  initEnergyMeter();        // Resume energy counters from RTC memory or NVS
+  initHistoryRollups();     // Resume hourly/daily history rollups the same way
+#if HISTORY_BLOCK_MODE
+  initHistoryBlocks();      // Resume the open history block from RTC memory
+#endif
+#if USE_BACKGROUND_CURRENT_SAMPLER
+  initCurrentSampler();     // Start continuous current sampling
+#endif
+  initHeaterClassifier();   // Threshold table, calibration and baseline from NVS
+  initThermalPredictor();   // Last thermal model fit from NVS
+  initControlTask();        // Sensing and relay control from here on
+  /*************************************
+   * Local control first               *
+   *     end                           *
+   ************************************/
+
+  delay(1000); // Wait a moment to ensure LEDs are ready
 
   initStatusLEDs(); // Initialize Status LEDs
+  initHistoryOutbox(); // History samples waiting from before the reboot
 
   // status.heater = HEATERS_OFF; // Start with heater off (updated to new enum)
   turnOffLed(LED_WIFI);     // Turn off WiFi LED (index 0)
@@ -45,9 +88,6 @@ void setup()
 
   status.wifi = CONNECTING; // Initial WiFi status
   initWiFi(status);         // Initialize WiFi
-  initTemperatureSensors(); // Initialize Temperature Sensors
-
-  delay(1000); // Wait a moment to ensure sensors are ready
 
   timeClient.begin();
   getTime(); // Initialize Time Manager
@@ -56,6 +96,14 @@ void setup()
 }
 void loop()
 {
+  // The control task drives the DS18B20 acquisition; keep a history row
+  recordSampleHistoryIfDue();
+  storeHistoricalDataIfDue(); // Chart history every 10 minutes, outbox first; no MQTT needed
+  updateHistoryRollups(); // Hourly/daily min/max/avg; written when a bucket closes
+#if HISTORY_BLOCK_MODE
+  updateHistoryBlocks();  // One columnar history block per hour, one PUT each
+#endif
+
   // Publish Firebase heartbeat every 30 seconds
   static unsigned long lastHeartbeat = 0;
   if (millis() - lastHeartbeat > 30000)
@@ -150,8 +198,7 @@ void loop()
   static unsigned long lastMQTTCheck = 0;
   if (status.mqtt == MQTT_STATE_CONNECTED && millis() - lastMQTTCheck > 1000) // Check every 1 second for faster response
   {
-    // Read all temperature sensors first
-    readAllSensors();
+    // Sensor values come from the last completed acquisition cycle
     static bool firstReading = true;
     if (firstReading)
     {
@@ -193,14 +240,33 @@ void loop()
   {
     handleMQTT();                  // This calls mqttClient.loop() internally
     status.mqtt = getMQTTStatus(); // Update MQTT status
+    publishSensorHealth();         // Probe fault summary once a minute
+    publishCurrentSpectrum();      // Current harmonic content once a minute
+    publishControlTaskStats();     // Control loop timing once a minute
+    publishReportStats();          // Publish/suppress counters every 5 minutes
+    publishThermalModel();         // Pre-heat model fit every 10 minutes
+    publishAlertStatus();          // Active alerts every 5 minutes
+    publishFirebaseBatchStats();   // Firebase flush latency and payload size every 5 minutes
+    publishOutboxStats();          // History outbox backlog every 5 minutes
+    publishRetentionStats();       // History retention results every 5 minutes
+    publishHistoryBlockStats();    // History block writes every 5 minutes
   }
   /*************************************
    *   MQTT Connection Management.     *
    *    end                        *
    *************************************/
 
-  // Update heater control and LEDs using the unified status object
+  // Reflect the control task's decisions in status, LEDs, MQTT and alerts
   updateHeaterControl(status);
-  // save Irms reading to Firebase periodically
-  updateIrmsToFirebase();
+  processAlerts(); // Email due alerts; may block on SMTP, never the relay
+  flushFirebaseBatchIfDue(); // Everything queued for ESP32/control in one PATCH
+  drainHistoryOutbox();      // Stored history samples to Firebase, oldest first
+  updateHistoryRetention();  // Daily removal of expired history days, one request per pass
+  // Integrate heater energy; rollups (and the Irms value) go out once per hour
+  updateEnergyMeter(isRelayCommandedOn(), getLastCurrentReading());
+  // Learn the zero-current baseline while the relay is off, unless current
+  // is flowing that should not be or a leakage reading is building up
+  learnCurrentBaseline(!isRelayCommandedOn() && getRelayFault() == RELAY_FAULT_NONE &&
+                       getRelayOffCurrent() <= BASELINE_MAX_RISE);
+  checkpointThermalModel(); // Thermal model to NVS at most hourly
 }
@@ -10,27 +10,38 @@
 #include <SPIFFS.h>
 #include "Config.h"
 #include "FirebaseService.h"
+#include "CurrentSampler.h"
+#include "HeaterClassifier.h"
+#include "FirebaseBatch.h"
 
 // Add these static variables at the top
 //for periodic Irms updates
 static unsigned long lastIrmsUpdate = 0;
-static double lastIrmsReading = 0;
+// Written by the control task, read from loop(); float stores are atomic
+static volatile float lastIrmsReading = 0;
+static volatile float lastCurrentReading = 0; // After baseline and noise correction
 
 EnergyMonitor emon1;
 
 // Get current reading for detailed heater analysis
 double getCurrentReading()
 {
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    // Latest completed window from the background sampler - O(1), no ADC work here
+    initCurrentSampler();
+    double Irms = getSampledIrms();
+#else
     // Initialize sensor on first call only (one-time setup)
     static bool initialized = false;
     if (!initialized)
     {
-        emon1.current(CURRENT_SENSOR_PIN, CALIBRATION_CONSTANT);
+        emon1.current(CURRENT_SENSOR_PIN, getHeaterClassifierTable().calibration);
         initialized = true;
     }
 
     // Read RMS current
     double Irms = emon1.calcIrms(SAMPLES_PER_READING);
+#endif
 #if DEBUG_SERIAL
     Serial.println("♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️♨️");
     Serial.print("Raw Irms reading: ");
@@ -41,105 +52,43 @@ double getCurrentReading()
     // Store last reading for Firebase updates
 lastIrmsReading = Irms;
 
+    // Zero-current offset learned while the relay is off
+    double baselineOffset = getCurrentBaseline();
+    double noiseThreshold = NOISE_THRESHOLD;
+#if USE_BACKGROUND_CURRENT_SAMPLER
+    if (getCurrentAnalysisMode() == CURRENT_MODE_FUNDAMENTAL)
+    {
+        noiseThreshold = SPECTRAL_NOISE_THRESHOLD;
+    }
+#endif
+
     // Apply baseline offset correction
-    Irms -= BASELINE_OFFSET;
+    Irms -= baselineOffset;
     if (Irms < 0)
         Irms = 0.0;
 
     // Filter noise
-    if (Irms < NOISE_THRESHOLD)
+    if (Irms < noiseThreshold)
     {
         Irms = 0.0;
     }
 
+    lastCurrentReading = Irms;
     return Irms;
 }
 
-HeaterState getHeaterState(double current)
+double getLastCurrentReading()
 {
-    static HeaterState lastState = BOTH_HEATERS_ON; // Remember last state
-    static const double HYSTERESIS = 0.2; // 0.2A deadband to prevent flickering
-    
-    // Determine raw state first
-    HeaterState rawState;
-    
-    if (current < 1.5)
-    {
-        rawState = BOTH_HEATERS_BLOWN;
-    }
-    else if (current >= 1.5 && current <= 2.8)
-    {
-        rawState = ONE_HEATER_ON;
-    }
-    else if (current > 2.8)
-    {
-        rawState = BOTH_HEATERS_ON;
-    }
-    else 
-    {
-        rawState = HEATERS_OFF;
-    }
-    
-    // Apply hysteresis to prevent rapid state changes
-    if (rawState != lastState) 
-    {
-        // Only change state if we're clearly in a different range
-        switch (lastState) 
-        {
-            case ONE_HEATER_ON:
-                // Need to be clearly above 3.0A to switch to BOTH_HEATERS_ON
-                if (current > 3.0) {
-                    lastState = BOTH_HEATERS_ON;
-                }
-                // Need to be clearly below 1.3A to switch to BOTH_HEATERS_BLOWN  
-                else if (current < 1.3) {
-                    lastState = BOTH_HEATERS_BLOWN;
-                }
-                break;
-                
-            case BOTH_HEATERS_ON:
-                // Need to be clearly below 2.6A to switch to ONE_HEATER_ON
-                if (current < 2.6) {
-                    lastState = ONE_HEATER_ON;
-                }
-                break;
-                
-            case BOTH_HEATERS_BLOWN:
-                // Need to be clearly above 1.7A to switch to ONE_HEATER_ON
-                if (current > 1.7) {
-                    lastState = ONE_HEATER_ON;
-                }
-                break;
-                
-            default:
-                lastState = rawState;
-                break;
-        }
-    }
-    
-    #if DEBUG_SERIAL
-        Serial.print("Current: ");
-        Serial.print(current, 2);
-        Serial.print("A, Raw state: ");
-        Serial.print(heaterStateToString(rawState));
-        Serial.print(", Final state: ");
-        Serial.println(heaterStateToString(lastState));
-    #endif
-    
-    return lastState;
+    return lastCurrentReading;
 }
 
-//Add this function for periodic updates
+// Called by the energy meter when an hourly rollup is written. Queued for
+// the next batch flush rather than sent with a blocking setFloat().
 void updateIrmsToFirebase() {
     unsigned long now = millis();
-    
-    // Update every 30 seconds
-    //if (fbInitialized && (now - lastIrmsUpdate > 30000)) {
-        if (Firebase.RTDB.setFloat(&fbData, "ESP32/control/IrmsReading", lastIrmsReading)) {
-            #if DEBUG_SERIAL
-                Serial.println("📊 Irms reading sent to Firebase");
-            #endif
-        //}
+
+    if (fbInitialized) {
+        queueFirebaseValue("IrmsReading", (float)lastIrmsReading);
         lastIrmsUpdate = now;
     }
 }
@@ -0,0 +1,399 @@
+// ==================================================
+// File: test/test_acquisition/test_main.cpp
+// ==================================================
+// Host tests for the DS18B20 acquisition state machine in
+// SensorAcquisition.h against a simulated 1-Wire bus: state transitions,
+// the conversion wait per resolution, retries and that no loop pass does
+// more than one bus operation.
+// Run with: pio test -e native -f test_acquisition
+
+#include <unity.h>
+#include <math.h>
+#include "SensorAcquisition.h"
+
+// Config.h / TemperatureSensors.h defaults
+#define READ_INTERVAL_MS 1000
+#define READ_RETRIES 2
+#define LOOP_PERIOD_MS 10
+
+// DallasTemperature::millisToWaitForConversion()
+static unsigned long conversionMs(uint8_t bits)
+{
+    switch (bits)
+    {
+    case 9:  return 94;
+    case 10: return 188;
+    case 11: return 375;
+    default: return 750;
+    }
+}
+
+// Simulated bus. Every call that would put traffic on the wire counts as
+// one operation; a probe read before its conversion time is an early read.
+struct MockBus
+{
+    unsigned long now;
+    int probes;
+    bool present[MAX_PROBES];
+    uint8_t bits[MAX_PROBES];
+    float temp[MAX_PROBES];
+    int failReads[MAX_PROBES]; // Reads left that fail, -1 = always
+    ProbeFault failAs[MAX_PROBES];
+    int housekeeping;          // Between-cycle jobs waiting
+
+    unsigned long convertedAt;
+    int operations;            // This step
+    int maxOperations;         // Over any step
+    int conversions;
+    int reads[MAX_PROBES];
+    int retries[MAX_PROBES];
+    ProbeFault done[MAX_PROBES];
+    int earlyReads;
+    int commits;
+    SensorSnapshot last;
+
+    bool betweenCycles(unsigned long)
+    {
+        if (housekeeping == 0)
+        {
+            return false;
+        }
+        housekeeping--;
+        operations++;
+        return true;
+    }
+
+    uint8_t conversionBits()
+    {
+        uint8_t highest = 9;
+        for (int i = 0; i < probes; i++)
+        {
+            if (present[i] && bits[i] > highest)
+            {
+                highest = bits[i];
+            }
+        }
+        return highest;
+    }
+
+    unsigned long startConversion(uint8_t highest)
+    {
+        operations++;
+        conversions++;
+        convertedAt = now;
+        return conversionMs(highest);
+    }
+
+    int probeCount()
+    {
+        return probes;
+    }
+
+    bool probePresent(int slot)
+    {
+        return present[slot];
+    }
+
+    ProbeFault readProbe(int slot, float &value)
+    {
+        operations++;
+        reads[slot]++;
+        if (now - convertedAt < conversionMs(bits[slot]))
+        {
+            earlyReads++;
+        }
+        if (failReads[slot] != 0)
+        {
+            if (failReads[slot] > 0)
+            {
+                failReads[slot]--;
+            }
+            return failAs[slot];
+        }
+        value = temp[slot];
+        return PROBE_OK;
+    }
+
+    void probeRetried(int slot)
+    {
+        retries[slot]++;
+    }
+
+    void probeDone(int slot, ProbeFault fault)
+    {
+        done[slot] = fault;
+    }
+
+    void commit(const SensorSnapshot &snapshot)
+    {
+        commits++;
+        last = snapshot;
+    }
+};
+
+static SensorAcquisition acq;
+static MockBus bus;
+
+void setUp()
+{
+    acqInit(acq, READ_INTERVAL_MS, READ_RETRIES);
+    bus = MockBus();
+    bus.now = 5000;
+    bus.probes = 3;
+    for (int i = 0; i < 3; i++)
+    {
+        bus.present[i] = true;
+        bus.bits[i] = 9;
+        bus.temp[i] = 20.0f + i;
+        bus.failAs[i] = PROBE_FAULT_CRC;
+    }
+}
+
+void tearDown() {}
+
+// One loop pass
+static void step()
+{
+    bus.operations = 0;
+    acqStep(acq, bus, bus.now);
+    if (bus.operations > bus.maxOperations)
+    {
+        bus.maxOperations = bus.operations;
+    }
+    bus.now += LOOP_PERIOD_MS;
+}
+
+static void runUntilCommits(int commits)
+{
+    for (int i = 0; i < 100000 && bus.commits < commits; i++)
+    {
+        step();
+    }
+}
+
+/****** state transitions ******/
+
+void test_cycle_walks_the_states()
+{
+    TEST_ASSERT_EQUAL_INT(SENSOR_ACQ_IDLE, acq.state);
+    step(); // First cycle starts at once
+    TEST_ASSERT_EQUAL_INT(SENSOR_ACQ_CONVERTING, acq.state);
+    TEST_ASSERT_EQUAL_INT(1, bus.conversions);
+    while (acq.state == SENSOR_ACQ_CONVERTING)
+    {
+        step();
+    }
+    TEST_ASSERT_EQUAL_INT(SENSOR_ACQ_READY, acq.state);
+    TEST_ASSERT_EQUAL_INT(0, bus.reads[0]); // The transition itself does not read
+    step();
+    step();
+    TEST_ASSERT_EQUAL_INT(SENSOR_ACQ_READY, acq.state);
+    TEST_ASSERT_EQUAL_INT(0, bus.commits);
+    step(); // Last probe read and the snapshot committed
+    TEST_ASSERT_EQUAL_INT(SENSOR_ACQ_IDLE, acq.state);
+    TEST_ASSERT_EQUAL_INT(1, bus.commits);
+    TEST_ASSERT_EQUAL_UINT32(1, acq.stats.cycles);
+}
+
+void test_snapshot_carries_every_probe()
+{
+    runUntilCommits(2);
+    TEST_ASSERT_EQUAL_UINT32(2, bus.last.sequence);
+    for (int i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_TRUE(bus.last.valid[i]);
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, 20.0f + i, bus.last.temperature[i]);
+        TEST_ASSERT_EQUAL_INT(PROBE_OK, bus.done[i]);
+    }
+}
+
+void test_cycles_start_one_interval_apart()
+{
+    runUntilCommits(1);
+    unsigned long first = bus.convertedAt;
+    while (acq.state != SENSOR_ACQ_CONVERTING)
+    {
+        step();
+    }
+    TEST_ASSERT_EQUAL_UINT32(READ_INTERVAL_MS, bus.convertedAt - first);
+}
+
+/****** conversion wait ******/
+
+// The read-back waits for the slowest probe and no longer than one loop pass
+void test_conversion_wait_follows_the_slowest_probe()
+{
+    for (uint8_t bits = 9; bits <= 12; bits++)
+    {
+        setUp();
+        bus.bits[1] = bits;
+        runUntilCommits(1);
+        TEST_ASSERT_EQUAL_UINT32(conversionMs(bits), acq.stats.lastConversionMs);
+        TEST_ASSERT_EQUAL_UINT8(bits, acq.stats.lastResolution);
+        TEST_ASSERT_EQUAL_INT(0, bus.earlyReads);
+        // One loop pass past the wait, then one pass per probe
+        TEST_ASSERT_LESS_OR_EQUAL(conversionMs(bits) + 4 * LOOP_PERIOD_MS, acq.stats.lastCycleMs);
+    }
+}
+
+// An absent 12-bit probe does not hold a 9-bit bus to 750 ms
+void test_absent_probe_does_not_set_the_wait()
+{
+    bus.bits[2] = 12;
+    bus.present[2] = false;
+    runUntilCommits(1);
+    TEST_ASSERT_EQUAL_UINT32(conversionMs(9), acq.stats.lastConversionMs);
+}
+
+/****** no stalls ******/
+
+// Housekeeping queued behind every cycle, failing probes and retries: no
+// loop pass may put more than one operation on the bus
+void test_no_step_does_more_than_one_bus_operation()
+{
+    bus.bits[0] = 12;
+    bus.failReads[1] = -1;
+    bus.failReads[2] = 1;
+    for (int i = 0; i < 6000; i++) // One minute of loop passes
+    {
+        if (i % 100 == 0)
+        {
+            bus.housekeeping += 3;
+        }
+        step();
+    }
+    TEST_ASSERT_EQUAL_INT(1, bus.maxOperations);
+    TEST_ASSERT_EQUAL_INT(0, bus.earlyReads);
+    TEST_ASSERT_GREATER_OR_EQUAL(59, (int)acq.stats.cycles);
+}
+
+// Housekeeping only runs between cycles, never during a conversion or read-back
+void test_housekeeping_waits_for_the_cycle()
+{
+    step();
+    bus.housekeeping = 1000;
+    while (acq.state != SENSOR_ACQ_IDLE)
+    {
+        step();
+    }
+    TEST_ASSERT_EQUAL_INT(1000, bus.housekeeping);
+    step();
+    TEST_ASSERT_EQUAL_INT(999, bus.housekeeping);
+}
+
+/****** retries and faults ******/
+
+void test_failed_read_is_retried_then_recovers()
+{
+    bus.failReads[1] = 1;
+    runUntilCommits(1);
+    TEST_ASSERT_EQUAL_INT(2, bus.reads[1]);
+    TEST_ASSERT_EQUAL_INT(1, bus.retries[1]);
+    TEST_ASSERT_TRUE(bus.last.valid[1]);
+    TEST_ASSERT_EQUAL_INT(PROBE_OK, bus.done[1]);
+}
+
+void test_retries_are_bounded()
+{
+    bus.failReads[1] = -1;
+    runUntilCommits(1);
+    TEST_ASSERT_EQUAL_INT(1 + READ_RETRIES, bus.reads[1]);
+    TEST_ASSERT_EQUAL_INT(PROBE_FAULT_CRC, bus.done[1]);
+    TEST_ASSERT_FALSE(bus.last.valid[1]);
+    TEST_ASSERT_TRUE(isnan(bus.last.temperature[1]));
+    TEST_ASSERT_TRUE(bus.last.valid[0]);
+    TEST_ASSERT_EQUAL_INT(SENSOR_ACQ_IDLE, acq.state);
+}
+
+// A power-on reset is not a bus error; reading it again would not help
+void test_power_on_reset_is_not_retried()
+{
+    bus.failReads[0] = 1;
+    bus.failAs[0] = PROBE_FAULT_POWER_ON_RESET;
+    runUntilCommits(1);
+    TEST_ASSERT_EQUAL_INT(1, bus.reads[0]);
+    TEST_ASSERT_FALSE(bus.last.valid[0]);
+}
+
+void test_stuck_probe_is_still_usable()
+{
+    bus.failReads[0] = -1;
+    bus.failAs[0] = PROBE_FAULT_STUCK;
+    runUntilCommits(1);
+    TEST_ASSERT_EQUAL_INT(1, bus.reads[0]);
+    TEST_ASSERT_EQUAL_INT(PROBE_FAULT_STUCK, bus.done[0]);
+    TEST_ASSERT_TRUE(bus.last.valid[0]);
+}
+
+void test_absent_probes_are_skipped()
+{
+    bus.present[1] = false;
+    runUntilCommits(1);
+    TEST_ASSERT_EQUAL_INT(0, bus.reads[1]);
+    TEST_ASSERT_FALSE(bus.last.valid[1]);
+    TEST_ASSERT_TRUE(isnan(bus.last.temperature[1]));
+    TEST_ASSERT_TRUE(bus.last.valid[2]);
+}
+
+// A bus with nothing answering ends in ERROR, and the next cycle still runs
+void test_dead_bus_reports_error_and_recovers()
+{
+    for (int i = 0; i < 3; i++)
+    {
+        bus.failReads[i] = -1;
+        bus.failAs[i] = PROBE_FAULT_DISCONNECTED;
+    }
+    runUntilCommits(1);
+    TEST_ASSERT_EQUAL_INT(SENSOR_ACQ_ERROR, acq.state);
+    TEST_ASSERT_EQUAL_UINT32(1, acq.stats.errorCycles);
+
+    for (int i = 0; i < 3; i++)
+    {
+        bus.failReads[i] = 0;
+    }
+    runUntilCommits(2);
+    TEST_ASSERT_EQUAL_INT(SENSOR_ACQ_IDLE, acq.state);
+    TEST_ASSERT_EQUAL_UINT32(1, acq.stats.errorCycles);
+    TEST_ASSERT_TRUE(bus.last.valid[0]);
+}
+
+// No probes at all: each cycle commits an empty snapshot instead of
+// waiting forever in READY
+void test_empty_bus_does_not_hang()
+{
+    bus.probes = 0;
+    runUntilCommits(3);
+    TEST_ASSERT_EQUAL_INT(3, bus.commits);
+    TEST_ASSERT_EQUAL_UINT32(3, acq.stats.errorCycles);
+}
+
+// A coarse probe holds one value longer, so it gets more cycles before
+// being called stuck
+void test_stuck_limit_scales_with_resolution()
+{
+    TEST_ASSERT_EQUAL_UINT32(1800, stuckCycleLimit(1800, 12));
+    TEST_ASSERT_EQUAL_UINT32(3600, stuckCycleLimit(1800, 11));
+    TEST_ASSERT_EQUAL_UINT32(14400, stuckCycleLimit(1800, 9));
+    TEST_ASSERT_EQUAL_UINT32(1800, stuckCycleLimit(1800, 0)); // Unknown resolution: strictest
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cycle_walks_the_states);
+    RUN_TEST(test_snapshot_carries_every_probe);
+    RUN_TEST(test_cycles_start_one_interval_apart);
+    RUN_TEST(test_conversion_wait_follows_the_slowest_probe);
+    RUN_TEST(test_absent_probe_does_not_set_the_wait);
+    RUN_TEST(test_no_step_does_more_than_one_bus_operation);
+    RUN_TEST(test_housekeeping_waits_for_the_cycle);
+    RUN_TEST(test_failed_read_is_retried_then_recovers);
+    RUN_TEST(test_retries_are_bounded);
+    RUN_TEST(test_power_on_reset_is_not_retried);
+    RUN_TEST(test_stuck_probe_is_still_usable);
+    RUN_TEST(test_absent_probes_are_skipped);
+    RUN_TEST(test_dead_bus_reports_error_and_recovers);
+    RUN_TEST(test_empty_bus_does_not_hang);
+    RUN_TEST(test_stuck_limit_scales_with_resolution);
+    return UNITY_END();
+}
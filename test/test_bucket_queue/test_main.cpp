@@ -0,0 +1,127 @@
+// ==================================================
+// File: test/test_bucket_queue/test_main.cpp
+// ==================================================
+// Host tests for the closed-bucket queue in BucketQueue.h shared by the
+// energy meter and the history rollups.
+// Run with: pio test -e native -f test_bucket_queue
+
+#include <unity.h>
+#include <string.h>
+#include "BucketQueue.h"
+
+struct TestBucket
+{
+    float value;
+};
+
+typedef BucketQueue<TestBucket, 4> TestQueue;
+
+static TestQueue queue;
+
+void setUp()
+{
+    memset(&queue, 0, sizeof(queue));
+}
+
+void tearDown() {}
+
+static void closeHour(uint32_t dayKey, int32_t hour)
+{
+    TestBucket bucket = {(float)hour};
+    bucketQueuePush(queue, dayKey, hour, bucket);
+}
+
+void test_buckets_leave_oldest_first()
+{
+    closeHour(20241107, 10);
+    closeHour(20241107, 11);
+    TEST_ASSERT_EQUAL_UINT16(2, queue.count);
+    TEST_ASSERT_EQUAL_INT32(10, bucketQueueFront(queue).hour);
+    bucketQueuePop(queue);
+    TEST_ASSERT_EQUAL_INT32(11, bucketQueueFront(queue).hour);
+    bucketQueuePop(queue);
+    TEST_ASSERT_EQUAL_UINT16(0, queue.count);
+    bucketQueuePop(queue); // Popping an empty queue is harmless
+    TEST_ASSERT_EQUAL_UINT16(0, queue.count);
+}
+
+// An outage longer than one period no longer overwrites the waiting bucket
+void test_outage_keeps_every_period_up_to_capacity()
+{
+    for (int32_t hour = 0; hour < 3; hour++)
+    {
+        closeHour(20241107, hour);
+    }
+    TEST_ASSERT_EQUAL_UINT16(3, queue.count);
+    for (int32_t hour = 0; hour < 3; hour++)
+    {
+        TEST_ASSERT_EQUAL_INT32(hour, bucketQueueFront(queue).hour);
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, (float)hour, bucketQueueFront(queue).bucket.value);
+        bucketQueuePop(queue);
+    }
+}
+
+void test_full_queue_drops_oldest()
+{
+    for (int32_t hour = 0; hour < 6; hour++)
+    {
+        closeHour(20241107, hour);
+    }
+    TEST_ASSERT_EQUAL_UINT16(4, queue.count);
+    TEST_ASSERT_EQUAL_UINT32(2, queue.dropped);
+    TEST_ASSERT_EQUAL_INT32(2, bucketQueueFront(queue).hour);
+}
+
+// The queue lives in RTC/NVS state; a byte copy must resume it
+void test_queue_survives_byte_copy()
+{
+    closeHour(20241107, 22);
+    closeHour(20241107, 23);
+    closeHour(20241108, 0);
+    bucketQueuePop(queue);
+
+    TestQueue restored;
+    memcpy(&restored, &queue, sizeof(queue));
+    TEST_ASSERT_TRUE(bucketQueueValid(restored));
+    TEST_ASSERT_EQUAL_UINT16(2, restored.count);
+    TEST_ASSERT_EQUAL_INT32(23, bucketQueueFront(restored).hour);
+}
+
+void test_garbage_state_is_rejected()
+{
+    queue.head = 4;
+    TEST_ASSERT_FALSE(bucketQueueValid(queue));
+    queue.head = 0;
+    queue.count = 5;
+    TEST_ASSERT_FALSE(bucketQueueValid(queue));
+}
+
+void test_period_of_epoch()
+{
+    uint32_t dayKey = 0;
+    int32_t hour = -1;
+    TEST_ASSERT_FALSE(bucketPeriodOf(0, dayKey, hour)); // Clock not set
+    TEST_ASSERT_TRUE(bucketPeriodOf(1730973600, dayKey, hour)); // 2024-11-07 10:00:00
+    TEST_ASSERT_EQUAL_UINT32(20241107, dayKey);
+    TEST_ASSERT_EQUAL_INT32(10, hour);
+}
+
+void test_format_day_key()
+{
+    char buffer[16];
+    formatDayKey(20240305, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("2024-03-05", buffer);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_buckets_leave_oldest_first);
+    RUN_TEST(test_outage_keeps_every_period_up_to_capacity);
+    RUN_TEST(test_full_queue_drops_oldest);
+    RUN_TEST(test_queue_survives_byte_copy);
+    RUN_TEST(test_garbage_state_is_rejected);
+    RUN_TEST(test_period_of_epoch);
+    RUN_TEST(test_format_day_key);
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+// ==================================================
+// File: test/test_classifier/test_main.cpp
+// ==================================================
+// Host tests for the table-driven heater classifier in HeaterBands.h:
+// every transition of the default 2x100 W table, with its hysteresis,
+// plus table validation.
+// Run with: pio test -e native -f test_classifier
+
+#include <unity.h>
+#include "HeaterBands.h"
+
+static HeaterClassifierTable table;
+
+void setUp()
+{
+    table = defaultHeaterTable(68.3f);
+}
+
+void tearDown() {}
+
+static HeaterState classify(HeaterState last, double current)
+{
+    return classifyHeaterCurrent(table, last, current);
+}
+
+/****** from start-up and states outside the table ******/
+
+void test_startup_goes_straight_to_band()
+{
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_BLOWN, classify(HEATER_STARTUP, 0.1));
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(HEATER_STARTUP, 2.0));
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_ON, classify(HEATER_STARTUP, 3.6));
+}
+
+void test_states_outside_table_have_no_deadband()
+{
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(HEATERS_OFF, 1.51));
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_ON, classify(HEATER_ENERGISED_WHEN_OFF, 2.81));
+}
+
+void test_below_table_is_lowest_band()
+{
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_BLOWN, classify(HEATER_STARTUP, -0.5));
+}
+
+/****** band to band, with hysteresis ******/
+
+void test_blown_to_one_heater()
+{
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_BLOWN, classify(BOTH_HEATERS_BLOWN, 1.60)); // In the 0.2 A deadband
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_BLOWN, classify(BOTH_HEATERS_BLOWN, 1.69));
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(BOTH_HEATERS_BLOWN, 1.71));
+}
+
+void test_one_heater_to_blown()
+{
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(ONE_HEATER_ON, 1.40));
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(ONE_HEATER_ON, 1.31));
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_BLOWN, classify(ONE_HEATER_ON, 1.29));
+}
+
+void test_one_heater_to_both()
+{
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(ONE_HEATER_ON, 2.90));
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(ONE_HEATER_ON, 2.99));
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_ON, classify(ONE_HEATER_ON, 3.01));
+}
+
+void test_both_to_one_heater()
+{
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_ON, classify(BOTH_HEATERS_ON, 2.70));
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_ON, classify(BOTH_HEATERS_ON, 2.61));
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(BOTH_HEATERS_ON, 2.59));
+}
+
+void test_blown_to_both_in_one_step()
+{
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_ON, classify(BOTH_HEATERS_BLOWN, 3.5));
+}
+
+void test_both_to_blown_in_one_step()
+{
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_BLOWN, classify(BOTH_HEATERS_ON, 0.05));
+}
+
+void test_same_band_is_kept()
+{
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_BLOWN, classify(BOTH_HEATERS_BLOWN, 0.0));
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classify(ONE_HEATER_ON, 2.2));
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_ON, classify(BOTH_HEATERS_ON, 50.0));
+}
+
+// Noise of +-0.15 A on a reading sitting on a boundary must not chatter
+void test_noise_on_boundary_does_not_chatter()
+{
+    HeaterState state = classify(HEATER_STARTUP, 2.85);
+    const double noise[] = {-0.15, 0.1, -0.12, 0.15, -0.05, 0.08, -0.14};
+    int changes = 0;
+    for (int round = 0; round < 10; round++)
+    {
+        for (double n : noise)
+        {
+            HeaterState next = classify(state, 2.8 + n);
+            changes += next != state;
+            state = next;
+        }
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(1, changes);
+}
+
+/****** other tables ******/
+
+void test_custom_table_for_other_wattage()
+{
+    HeaterClassifierTable custom = {
+        3,
+        {
+            {HEATERS_OFF, 0.0, 0.3, 0.05},
+            {ONE_HEATER_ON, 0.3, 0.7, 0.05},
+            {BOTH_HEATERS_ON, 0.7, 100.0, 0.05},
+        },
+        30.0f};
+    TEST_ASSERT_TRUE(isValidHeaterTable(custom));
+    TEST_ASSERT_EQUAL_INT(HEATERS_OFF, classifyHeaterCurrent(custom, HEATER_STARTUP, 0.1));
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classifyHeaterCurrent(custom, HEATERS_OFF, 0.4));
+    TEST_ASSERT_EQUAL_INT(ONE_HEATER_ON, classifyHeaterCurrent(custom, ONE_HEATER_ON, 0.72));
+    TEST_ASSERT_EQUAL_INT(BOTH_HEATERS_ON, classifyHeaterCurrent(custom, ONE_HEATER_ON, 0.8));
+}
+
+void test_default_table_is_valid()
+{
+    TEST_ASSERT_TRUE(isValidHeaterTable(table));
+}
+
+void test_invalid_tables_are_rejected()
+{
+    HeaterClassifierTable bad = table;
+    bad.bandCount = 0;
+    TEST_ASSERT_FALSE(isValidHeaterTable(bad));
+
+    bad = table;
+    bad.bandCount = HEATER_MAX_BANDS + 1;
+    TEST_ASSERT_FALSE(isValidHeaterTable(bad));
+
+    bad = table;
+    bad.calibration = 0.0f;
+    TEST_ASSERT_FALSE(isValidHeaterTable(bad));
+
+    bad = table;
+    bad.bands[1].upper = bad.bands[1].lower; // Empty band
+    TEST_ASSERT_FALSE(isValidHeaterTable(bad));
+
+    bad = table;
+    bad.bands[2].hysteresis = -0.1f;
+    TEST_ASSERT_FALSE(isValidHeaterTable(bad));
+
+    bad = table;
+    bad.bands[2].lower = 1.0f; // Out of order
+    TEST_ASSERT_FALSE(isValidHeaterTable(bad));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_startup_goes_straight_to_band);
+    RUN_TEST(test_states_outside_table_have_no_deadband);
+    RUN_TEST(test_below_table_is_lowest_band);
+    RUN_TEST(test_blown_to_one_heater);
+    RUN_TEST(test_one_heater_to_blown);
+    RUN_TEST(test_one_heater_to_both);
+    RUN_TEST(test_both_to_one_heater);
+    RUN_TEST(test_blown_to_both_in_one_step);
+    RUN_TEST(test_both_to_blown_in_one_step);
+    RUN_TEST(test_same_band_is_kept);
+    RUN_TEST(test_noise_on_boundary_does_not_chatter);
+    RUN_TEST(test_custom_table_for_other_wattage);
+    RUN_TEST(test_default_table_is_valid);
+    RUN_TEST(test_invalid_tables_are_rejected);
+    return UNITY_END();
+}
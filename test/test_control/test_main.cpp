@@ -0,0 +1,214 @@
+// ==================================================
+// File: test/test_control/test_main.cpp
+// ==================================================
+// Host benchmark of the two heater control modes in PiControl.h against a
+// simulated enclosure: overshoot, settling time and relay cycles per day.
+// Run with: pio test -e native -f test_control -v   (-v prints the table)
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "PiControl.h"
+
+// Config.h defaults
+#define KP 0.5f
+#define INTEGRAL_TIME_S 1200.0f
+#define WINDOW_MS 60000
+#define MIN_ON_MS 10000
+#define MIN_OFF_MS 10000
+
+#define DECISION_MS 1000 // CONTROL_DECISION_TICKS x CONTROL_TASK_PERIOD_MS
+#define DAY_S 86400
+
+// Two-node enclosure: the bulbs store heat and keep warming the air after
+// the relay opens, which is where bang-bang control overshoots.
+struct Enclosure
+{
+    float bulb;   // °C
+    float air;    // °C, what the probe sees (after its own lag)
+    float probe;  // °C
+    float ambient;
+};
+
+static const float HEATER_W = 200.0f;
+static const float BULB_J_PER_K = 300.0f;
+static const float BULB_TO_AIR_W_PER_K = 4.0f;
+static const float AIR_J_PER_K = 6000.0f;
+static const float AIR_TO_ROOM_W_PER_K = 12.0f;
+static const float PROBE_TAU_S = 20.0f;
+
+static void enclosureStep(Enclosure &e, bool on, float dtS)
+{
+    float toAir = BULB_TO_AIR_W_PER_K * (e.bulb - e.air);
+    float toRoom = AIR_TO_ROOM_W_PER_K * (e.air - e.ambient);
+    e.bulb += ((on ? HEATER_W : 0.0f) - toAir) / BULB_J_PER_K * dtS;
+    e.air += (toAir - toRoom) / AIR_J_PER_K * dtS;
+    e.probe += (e.air - e.probe) / PROBE_TAU_S * dtS;
+}
+
+// DS18B20 at 12 bits
+static float quantise(float t)
+{
+    return roundf(t * 16.0f) / 16.0f;
+}
+
+struct Benchmark
+{
+    float overshoot;    // °C above target after the step
+    float settlingS;    // Until the air stays within SETTLE_BAND of target; -1 if it never does
+    float cyclesPerDay; // Relay off->on transitions in steady state
+    float rmsError;     // °C, steady state
+};
+
+static const float SETTLE_BAND = 0.5f;
+
+// Step from ambient-warm to target, then a day at steady state
+static Benchmark run(bool usePi, float target)
+{
+    Enclosure e = {24.0f, 24.0f, 24.0f, 22.0f};
+    PiController pi;
+    piInit(pi, KP, INTEGRAL_TIME_S);
+    TimeProportioner tp;
+    tpInit(tp, WINDOW_MS, MIN_ON_MS, MIN_OFF_MS);
+
+    Benchmark result = {0, 0, 0, 0};
+    bool relay = false;
+    float lastOutside = 0;
+    uint32_t cycles = 0;
+    double squaredError = 0;
+    uint32_t steadySamples = 0;
+    const uint32_t stepSeconds = 4 * 3600;
+
+    for (uint32_t ms = 0; ms < (stepSeconds + DAY_S) * 1000UL; ms += DECISION_MS)
+    {
+        float measured = quantise(e.probe);
+        bool next = relay;
+        if (usePi)
+        {
+            float duty = piUpdate(pi, target - measured, DECISION_MS / 1000.0f);
+            next = tpUpdate(tp, duty, ms);
+        }
+        else
+        {
+            HeaterDemand demand = hysteresisDemand(measured, target, HYSTERESIS_BAND);
+            if (demand != DEMAND_HOLD)
+            {
+                next = demand == DEMAND_ON;
+            }
+        }
+        bool steady = ms >= stepSeconds * 1000UL;
+        if (steady && next && !relay)
+        {
+            cycles++;
+        }
+        relay = next;
+
+        for (int i = 0; i < 10; i++)
+        {
+            enclosureStep(e, relay, DECISION_MS / 10000.0f);
+        }
+
+        float t = ms / 1000.0f;
+        if (e.air - target > result.overshoot)
+        {
+            result.overshoot = e.air - target;
+        }
+        if (fabsf(e.air - target) > SETTLE_BAND)
+        {
+            lastOutside = t;
+        }
+        if (steady)
+        {
+            squaredError += (e.air - target) * (e.air - target);
+            steadySamples++;
+        }
+    }
+    result.settlingS = lastOutside >= stepSeconds ? -1.0f : lastOutside; // Still leaves the band in steady state
+    result.cyclesPerDay = (float)cycles;
+    result.rmsError = (float)sqrt(squaredError / steadySamples);
+    return result;
+}
+
+static Benchmark hysteresis;
+static Benchmark piMode;
+
+void setUp() {}
+void tearDown() {}
+
+void test_benchmark_report()
+{
+    hysteresis = run(false, 30.0f);
+    piMode = run(true, 30.0f);
+    const char *names[2] = {"hysteresis", "pi"};
+    const Benchmark *results[2] = {&hysteresis, &piMode};
+    char line[160];
+    TEST_MESSAGE("mode        overshoot  settling  cycles/day  rms");
+    for (int i = 0; i < 2; i++)
+    {
+        char settling[16];
+        if (results[i]->settlingS < 0)
+        {
+            snprintf(settling, sizeof(settling), "never");
+        }
+        else
+        {
+            snprintf(settling, sizeof(settling), "%.0f s", results[i]->settlingS);
+        }
+        snprintf(line, sizeof(line), "%-10s  %6.2f C  %8s  %10.0f  %4.2f C", names[i],
+                 results[i]->overshoot, settling, results[i]->cyclesPerDay, results[i]->rmsError);
+        TEST_MESSAGE(line);
+    }
+}
+
+void test_pi_overshoots_less()
+{
+    TEST_ASSERT_LESS_THAN(hysteresis.overshoot, piMode.overshoot);
+}
+
+void test_pi_settles_within_band()
+{
+    TEST_ASSERT_GREATER_OR_EQUAL(0.0f, piMode.settlingS);
+    TEST_ASSERT_LESS_THAN(3600.0f, piMode.settlingS);
+    TEST_ASSERT_LESS_THAN(SETTLE_BAND / 2, piMode.rmsError);
+}
+
+// The window switches at most once per minute, and never faster than the
+// minimum on/off times allow
+void test_pi_cycles_bounded_by_window()
+{
+    TEST_ASSERT_LESS_OR_EQUAL(DAY_S / (WINDOW_MS / 1000), piMode.cyclesPerDay);
+}
+
+void test_min_on_off_times_are_respected()
+{
+    TimeProportioner tp;
+    tpInit(tp, WINDOW_MS, MIN_ON_MS, MIN_OFF_MS);
+    TEST_ASSERT_EQUAL_UINT32(0, tpOnTime(tp, 0.1f));             // 6 s would break min on
+    TEST_ASSERT_EQUAL_UINT32(WINDOW_MS, tpOnTime(tp, 0.9f));     // 6 s off would break min off
+    TEST_ASSERT_EQUAL_UINT32(WINDOW_MS / 2, tpOnTime(tp, 0.5f));
+}
+
+void test_integral_does_not_wind_up()
+{
+    PiController pi;
+    piInit(pi, KP, INTEGRAL_TIME_S);
+    for (int i = 0; i < 36000; i++)
+    {
+        piUpdate(pi, 10.0f, 1.0f); // Far below target for 10 h
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(1.0f, pi.integral);
+    // Output drops as soon as the error reverses
+    TEST_ASSERT_LESS_THAN(1.0f, piUpdate(pi, -0.5f, 1.0f));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_report);
+    RUN_TEST(test_pi_overshoots_less);
+    RUN_TEST(test_pi_settles_within_band);
+    RUN_TEST(test_pi_cycles_bounded_by_window);
+    RUN_TEST(test_min_on_off_times_are_respected);
+    RUN_TEST(test_integral_does_not_wind_up);
+    return UNITY_END();
+}
@@ -0,0 +1,331 @@
+// ==================================================
+// File: test/test_current/test_main.cpp
+// ==================================================
+// Host tests for the fixed-point RMS and Goertzel math in CurrentMath.h,
+// fed by an ADC stand-in: a 12-bit converter sampling a CT burden that
+// carries a mains sine, harmonics and noise on a mid-rail offset.
+// Run with: pio test -e native -f test_current
+
+#include <unity.h>
+#include <math.h>
+#include "CurrentMath.h"
+
+// CurrentSampler.h / Config.h defaults
+#define SAMPLE_RATE 10000
+#define MAINS_HZ 50
+#define SAMPLES_PER_CYCLE (SAMPLE_RATE / MAINS_HZ)
+#define WINDOW_SAMPLES (SAMPLES_PER_CYCLE * 10)
+#define SPECTRAL_WINDOW_SAMPLES (SAMPLES_PER_CYCLE * 4)
+#define CALIBRATION 68.3
+#define AMPS_PER_COUNT (CALIBRATION * 3.3 / 4096.0)
+
+// ADC stand-in: fundamental plus 3rd and 5th harmonics (peak counts) on a
+// DC offset, with uniform noise, rounded and clipped to 12 bits
+struct AdcStandIn
+{
+    double offset;
+    double fundamental;
+    double harmonic3;
+    double harmonic5;
+    double noise; // Peak of the uniform noise, counts
+    double phase; // Radians at sample 0
+    uint32_t n;
+    uint32_t seed;
+};
+
+static AdcStandIn adc;
+
+static double noiseSample(AdcStandIn &a)
+{
+    a.seed = a.seed * 1664525u + 1013904223u; // LCG, repeatable across hosts
+    return ((a.seed >> 8) / 8388608.0 - 1.0) * a.noise;
+}
+
+static uint16_t adcRead(AdcStandIn &a)
+{
+    double w = 2.0 * M_PI * MAINS_HZ * a.n++ / SAMPLE_RATE + a.phase;
+    double v = a.offset + a.fundamental * sin(w) + a.harmonic3 * sin(3 * w) +
+               a.harmonic5 * sin(5 * w) + noiseSample(a);
+    long counts = lround(v);
+    return (uint16_t)(counts < 0 ? 0 : counts > 4095 ? 4095 : counts);
+}
+
+// Mean square (Q4) -> RMS counts, as readCurrentSample() does
+static double rmsCounts(uint32_t meanSquare)
+{
+    return sqrt((double)meanSquare) / 4.0;
+}
+
+// Runs whole windows and returns the RMS of the last one, in counts
+static double runWindows(RmsAccumulator &acc, int windows)
+{
+    uint32_t meanSquare = 0;
+    int done = 0;
+    while (done < windows)
+    {
+        done += rmsAddSample(acc, adcRead(adc), meanSquare) ? 1 : 0;
+    }
+    return rmsCounts(meanSquare);
+}
+
+void setUp()
+{
+    adc = {2048.0, 0.0, 0.0, 0.0, 0.0, 0.3, 0, 12345};
+}
+
+void tearDown() {}
+
+/****** broadband RMS ******/
+
+void test_sine_rms_is_accurate()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    adc.fundamental = 1000.0;
+    TEST_ASSERT_FLOAT_WITHIN(1000.0 / M_SQRT2 * 0.002, 1000.0 / M_SQRT2, runWindows(acc, 3));
+}
+
+// One 100 W heater at 230 V is ~0.43 A, about 19 counts RMS
+void test_small_current_is_resolved()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    adc.fundamental = 0.435 * M_SQRT2 / AMPS_PER_COUNT;
+    double amps = runWindows(acc, 3) * AMPS_PER_COUNT;
+    TEST_ASSERT_FLOAT_WITHIN(0.02, 0.435, amps);
+}
+
+// Uncorrelated noise adds in quadrature
+void test_noise_adds_in_quadrature()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    adc.fundamental = 500.0;
+    adc.noise = 40.0;
+    double expected = sqrt(500.0 * 500.0 / 2 + 40.0 * 40.0 / 3);
+    TEST_ASSERT_FLOAT_WITHIN(expected * 0.01, expected, runWindows(acc, 5));
+}
+
+void test_no_current_reads_near_zero()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    adc.noise = 2.0;
+    TEST_ASSERT_LESS_THAN(2.0, runWindows(acc, 3)); // ~1.2 counts of noise, ~0.06 A
+}
+
+/****** offset tracking ******/
+
+// The CT bias divider is rarely exactly mid-rail; the 1/1024 low-pass
+// must settle on the real offset within a few windows. The estimate keeps
+// a ripple of about A * 200 / (2*pi*1024) at the mains frequency, which is
+// in quadrature with the signal and barely moves the RMS.
+void test_offset_tracks_real_midpoint()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    adc.offset = 1930.0;
+    adc.fundamental = 800.0;
+    double rms = runWindows(acc, 10);
+    double ripple = 800.0 * SAMPLES_PER_CYCLE / (2 * M_PI * 1024);
+    TEST_ASSERT_FLOAT_WITHIN(ripple + 1.0, 1930.0, acc.offsetQ16 / 65536.0);
+    TEST_ASSERT_FLOAT_WITHIN(800.0 / M_SQRT2 * 0.005, 800.0 / M_SQRT2, rms);
+}
+
+/****** fixed-point range ******/
+
+// A full-scale square wave is the worst case for the Q4 sum (2048^2 * 16 =
+// 2^26 per sample): the window mean must match a double-precision
+// reference instead of wrapping
+void test_full_scale_swing_does_not_overflow()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    acc.offsetQ16 = 2048 << 16;
+    uint32_t meanSquare = 0;
+    double reference = 0;
+    uint32_t i = 0;
+    bool done = false;
+    while (!done)
+    {
+        uint16_t raw = (i++ / (SAMPLES_PER_CYCLE / 2)) % 2 ? 4095 : 0;
+        int32_t centred = rmsCentre(acc, raw);
+        reference += (double)centred * centred;
+        done = rmsAddCentred(acc, centred, meanSquare);
+    }
+    reference /= WINDOW_SAMPLES;
+    TEST_ASSERT_GREATER_THAN(1u << 25, meanSquare);
+    TEST_ASSERT_FLOAT_WITHIN(1.0, reference, (double)meanSquare);
+    TEST_ASSERT_FLOAT_WITHIN(2.0, 2048.0, rmsCounts(meanSquare));
+}
+
+// A clipped input reads low rather than wrapping to a small value
+void test_clipped_input_reads_low_not_wrapped()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    adc.fundamental = 3000.0; // Well past the rails
+    double rms = runWindows(acc, 3);
+    TEST_ASSERT_GREATER_THAN(1400.0, rms);
+    TEST_ASSERT_LESS_THAN(3000.0 / M_SQRT2, rms);
+}
+
+/****** window handling ******/
+
+void test_window_completes_every_window_samples()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    adc.fundamental = 100.0;
+    uint32_t meanSquare;
+    uint32_t completions[3];
+    int found = 0;
+    for (uint32_t i = 1; i <= 3 * WINDOW_SAMPLES && found < 3; i++)
+    {
+        if (rmsAddSample(acc, adcRead(adc), meanSquare))
+        {
+            completions[found++] = i;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(3, found);
+    TEST_ASSERT_EQUAL_UINT32(WINDOW_SAMPLES, completions[0]);
+    TEST_ASSERT_EQUAL_UINT32(2 * WINDOW_SAMPLES, completions[1]);
+    TEST_ASSERT_EQUAL_UINT32(3 * WINDOW_SAMPLES, completions[2]);
+    TEST_ASSERT_EQUAL_UINT32(0, acc.samples);
+}
+
+// After the sampler pauses, a restart drops the partial window and the next
+// one is a whole window again. The offset ripple left by the larger signal
+// decays over that window, so allow 2 %.
+void test_restart_drops_partial_window()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, WINDOW_SAMPLES, 2048);
+    adc.fundamental = 1000.0;
+    uint32_t meanSquare;
+    for (int i = 0; i < WINDOW_SAMPLES / 3; i++)
+    {
+        rmsAddSample(acc, adcRead(adc), meanSquare);
+    }
+    rmsRestart(acc);
+    TEST_ASSERT_EQUAL_UINT32(0, acc.samples);
+    TEST_ASSERT_TRUE(acc.sumSquares == 0);
+
+    adc.fundamental = 200.0;
+    uint32_t count = 0;
+    while (!rmsAddSample(acc, adcRead(adc), meanSquare))
+    {
+        count++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(WINDOW_SAMPLES - 1, count);
+    TEST_ASSERT_FLOAT_WITHIN(200.0 / M_SQRT2 * 0.02, 200.0 / M_SQRT2, rmsCounts(meanSquare));
+}
+
+/****** Goertzel bins ******/
+
+// Runs one spectral window through the sampler's three bins
+static void runSpectrum(RmsAccumulator &acc, double rms[3])
+{
+    GoertzelBin bins[3];
+    goertzelInit(bins[0], MAINS_HZ, SAMPLE_RATE);
+    goertzelInit(bins[1], 3 * MAINS_HZ, SAMPLE_RATE);
+    goertzelInit(bins[2], 5 * MAINS_HZ, SAMPLE_RATE);
+    for (int i = 0; i < SPECTRAL_WINDOW_SAMPLES; i++)
+    {
+        int32_t centred = rmsCentre(acc, adcRead(adc));
+        for (int b = 0; b < 3; b++)
+        {
+            goertzelAdd(bins[b], centred);
+        }
+    }
+    for (int b = 0; b < 3; b++)
+    {
+        rms[b] = goertzelRmsCounts(bins[b], SPECTRAL_WINDOW_SAMPLES);
+    }
+}
+
+void test_goertzel_separates_harmonics()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, SPECTRAL_WINDOW_SAMPLES, 2048);
+    adc.fundamental = 900.0;
+    adc.harmonic3 = 150.0;
+    adc.harmonic5 = 60.0;
+    double rms[3];
+    runSpectrum(acc, rms);
+    TEST_ASSERT_FLOAT_WITHIN(900.0 / M_SQRT2 * 0.005, 900.0 / M_SQRT2, rms[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.2, 150.0 / M_SQRT2, rms[1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.2, 60.0 / M_SQRT2, rms[2]);
+}
+
+// A pure fundamental must not leak into the harmonic bins; what is left is
+// the offset estimate settling, not the bin coefficients
+void test_goertzel_harmonic_bins_stay_empty()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, SPECTRAL_WINDOW_SAMPLES, 2048);
+    adc.fundamental = 1500.0;
+    double rms[3];
+    runSpectrum(acc, rms);
+    TEST_ASSERT_LESS_THAN(0.5, rms[1]);
+    TEST_ASSERT_LESS_THAN(0.5, rms[2]);
+}
+
+// A full-scale sine over the longer broadband window stays within the
+// 64-bit state
+void test_goertzel_full_scale_long_window()
+{
+    GoertzelBin bin;
+    goertzelInit(bin, MAINS_HZ, SAMPLE_RATE);
+    for (int i = 0; i < WINDOW_SAMPLES; i++)
+    {
+        goertzelAdd(bin, (int32_t)lround(4 * 2047 * sin(2 * M_PI * MAINS_HZ * i / SAMPLE_RATE)));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 2047.0 / M_SQRT2, goertzelRmsCounts(bin, WINDOW_SAMPLES));
+}
+
+// Broadband noise is spread over every bin; the fundamental barely moves
+void test_goertzel_rejects_broadband_noise()
+{
+    RmsAccumulator acc;
+    rmsInit(acc, SPECTRAL_WINDOW_SAMPLES, 2048);
+    adc.fundamental = 30.0; // ~0.7 A
+    adc.noise = 60.0;
+    double rms[3];
+    runSpectrum(acc, rms);
+    TEST_ASSERT_FLOAT_WITHIN(30.0 / M_SQRT2 * 0.1, 30.0 / M_SQRT2, rms[0]);
+}
+
+// Reading a bin clears it for the next window
+void test_goertzel_read_clears_state()
+{
+    GoertzelBin bin;
+    goertzelInit(bin, MAINS_HZ, SAMPLE_RATE);
+    for (int i = 0; i < SPECTRAL_WINDOW_SAMPLES; i++)
+    {
+        goertzelAdd(bin, (int32_t)(4 * 500 * sin(2 * M_PI * MAINS_HZ * i / SAMPLE_RATE)));
+    }
+    TEST_ASSERT_GREATER_THAN(300.0, goertzelRmsCounts(bin, SPECTRAL_WINDOW_SAMPLES));
+    TEST_ASSERT_TRUE(bin.s1 == 0 && bin.s2 == 0);
+    TEST_ASSERT_FLOAT_WITHIN(0.0, 0.0, goertzelRmsCounts(bin, 0));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sine_rms_is_accurate);
+    RUN_TEST(test_small_current_is_resolved);
+    RUN_TEST(test_noise_adds_in_quadrature);
+    RUN_TEST(test_no_current_reads_near_zero);
+    RUN_TEST(test_offset_tracks_real_midpoint);
+    RUN_TEST(test_full_scale_swing_does_not_overflow);
+    RUN_TEST(test_clipped_input_reads_low_not_wrapped);
+    RUN_TEST(test_window_completes_every_window_samples);
+    RUN_TEST(test_restart_drops_partial_window);
+    RUN_TEST(test_goertzel_separates_harmonics);
+    RUN_TEST(test_goertzel_harmonic_bins_stay_empty);
+    RUN_TEST(test_goertzel_full_scale_long_window);
+    RUN_TEST(test_goertzel_rejects_broadband_noise);
+    RUN_TEST(test_goertzel_read_clears_state);
+    return UNITY_END();
+}
@@ -0,0 +1,292 @@
+// ==================================================
+// File: test/test_outbox/test_main.cpp
+// ==================================================
+// Host tests for the history outbox replay rules in OutboxRing.h. The
+// LittleFS ring file is an in-memory slot array and Firebase is a local
+// stand-in that can be taken offline, so outages can be simulated.
+// Run with: pio test -e native -f test_outbox
+
+#include <unity.h>
+#include <map>
+#include <vector>
+#include "OutboxRing.h"
+
+#define BATCH 8
+#define BASE_INTERVAL_MS 5000
+#define MAX_INTERVAL_MS 300000
+#define SAMPLE_INTERVAL_S 600 // storeHistoricalDataIfDue()
+
+// Firebase stand-in: accepts an update only while online
+struct FakeFirebase
+{
+    bool online;
+    uint32_t updates;
+    uint32_t rejected;
+    std::map<uint32_t, OutboxRecord> history; // Keyed by epoch like daily/<date>/<time>
+};
+
+// The outbox file and the state drainHistoryOutbox() keeps
+struct FakeOutbox
+{
+    OutboxRing ring;
+    std::vector<OutboxRecord> slots;
+    uint32_t evicted;
+    uint32_t interval;
+    uint32_t lastReplay;
+};
+
+static FakeFirebase firebase;
+static FakeOutbox outbox;
+
+static void resetOutbox(uint32_t capacity)
+{
+    outboxRingInit(outbox.ring, capacity);
+    outbox.slots.assign(capacity, OutboxRecord());
+    outbox.evicted = 0;
+    outbox.interval = BASE_INTERVAL_MS;
+    outbox.lastReplay = 0;
+}
+
+void setUp()
+{
+    firebase.online = true;
+    firebase.updates = 0;
+    firebase.rejected = 0;
+    firebase.history.clear();
+    resetOutbox(64);
+}
+
+void tearDown() {}
+
+// appendHistoryRecord()
+static void append(uint32_t epoch)
+{
+    OutboxRecord record;
+    record.epoch = epoch;
+    for (int i = 0; i < 3; i++)
+    {
+        record.centi[i] = (int16_t)(2000 + (epoch / SAMPLE_INTERVAL_S) % 100 + i);
+    }
+    record.check = outboxRecordCheck(record);
+    bool evicted = false;
+    uint32_t slot = outboxRingPush(outbox.ring, &evicted);
+    outbox.slots[slot] = record;
+    if (evicted)
+    {
+        outbox.evicted++;
+    }
+}
+
+// One drainHistoryOutbox() pass; returns the batch it collected
+static OutboxBatch drain(uint32_t maxPerUpdate = BATCH)
+{
+    std::vector<OutboxRecord> pending;
+    OutboxBatch batch = outboxCollectBatch(
+        outbox.ring, BATCH,
+        [](uint32_t slot, OutboxRecord &record)
+        {
+            record = outbox.slots[slot];
+            return true;
+        },
+        [&](const OutboxRecord &record, uint32_t index)
+        {
+            if (index >= maxPerUpdate)
+            {
+                return false; // Payload full
+            }
+            pending.push_back(record);
+            return true;
+        });
+
+    bool delivered = true;
+    if (batch.sent > 0)
+    {
+        delivered = firebase.online;
+        if (delivered)
+        {
+            firebase.updates++;
+            for (const OutboxRecord &record : pending)
+            {
+                firebase.history[record.epoch] = record;
+            }
+        }
+        else
+        {
+            firebase.rejected++;
+        }
+        outbox.interval = outboxNextInterval(outbox.interval, delivered, BASE_INTERVAL_MS, MAX_INTERVAL_MS);
+    }
+    outboxCompleteBatch(outbox.ring, batch, delivered);
+    return batch;
+}
+
+// Runs loop() once a second from startEpoch for the given time. A sample
+// is appended every SAMPLE_INTERVAL_S regardless of connectivity; isOnline
+// decides whether the stand-in accepts updates at each second.
+template <typename OnlineFn>
+static void simulate(uint32_t startEpoch, uint32_t seconds, OnlineFn isOnline)
+{
+    for (uint32_t t = 0; t < seconds; t++)
+    {
+        uint32_t epoch = startEpoch + t;
+        uint32_t nowMs = t * 1000UL;
+        firebase.online = isOnline(t);
+        if (t % SAMPLE_INTERVAL_S == 0)
+        {
+            append(epoch);
+        }
+        if (outbox.ring.count > 0 && nowMs - outbox.lastReplay >= outbox.interval)
+        {
+            outbox.lastReplay = nowMs;
+            drain();
+        }
+    }
+}
+
+static const uint32_t START = 1730970000UL; // 2024-11-07
+
+/****** outages ******/
+
+void test_outage_leaves_no_holes()
+{
+    resetOutbox(4320);
+    const uint32_t day = 24UL * 3600UL;
+    // Six-hour outage on the first day, a 25-minute blip on the second
+    simulate(START, 2 * day,
+             [](uint32_t t)
+             {
+                 return !(t >= 5 * 3600 && t < 11 * 3600) && !(t >= 30 * 3600 && t < 30 * 3600 + 1500);
+             });
+    simulate(START + 2 * day, 3600, [](uint32_t) { return true; }); // Let the backlog drain
+
+    const uint32_t expected = (2 * day + 3600) / SAMPLE_INTERVAL_S;
+    TEST_ASSERT_EQUAL_UINT32(0, outbox.ring.count);
+    TEST_ASSERT_EQUAL_UINT32(0, outbox.evicted);
+    TEST_ASSERT_GREATER_THAN(0, firebase.rejected);
+    TEST_ASSERT_EQUAL_UINT32(expected, firebase.history.size());
+    uint32_t epoch = START;
+    for (const auto &entry : firebase.history)
+    {
+        TEST_ASSERT_EQUAL_UINT32(epoch, entry.first); // One record every interval, none missing
+        TEST_ASSERT_EQUAL_INT16(2000 + (epoch / SAMPLE_INTERVAL_S) % 100, entry.second.centi[0]);
+        epoch += SAMPLE_INTERVAL_S;
+    }
+}
+
+void test_failed_update_keeps_records()
+{
+    append(START);
+    append(START + SAMPLE_INTERVAL_S);
+    firebase.online = false;
+    OutboxBatch batch = drain();
+    TEST_ASSERT_EQUAL_UINT32(2, batch.sent);
+    TEST_ASSERT_EQUAL_UINT32(2, outbox.ring.count);
+    TEST_ASSERT_EQUAL_UINT32(0, firebase.history.size());
+
+    firebase.online = true;
+    drain();
+    TEST_ASSERT_EQUAL_UINT32(0, outbox.ring.count);
+    TEST_ASSERT_EQUAL_UINT32(2, firebase.history.size());
+}
+
+void test_outage_longer_than_ring_keeps_newest()
+{
+    resetOutbox(16);
+    firebase.online = false;
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        append(START + i * SAMPLE_INTERVAL_S);
+        drain();
+    }
+    TEST_ASSERT_EQUAL_UINT32(14, outbox.evicted);
+    TEST_ASSERT_EQUAL_UINT32(16, outbox.ring.count);
+
+    firebase.online = true;
+    while (outbox.ring.count > 0)
+    {
+        drain();
+    }
+    TEST_ASSERT_EQUAL_UINT32(16, firebase.history.size());
+    TEST_ASSERT_EQUAL_UINT32(START + 14 * SAMPLE_INTERVAL_S, firebase.history.begin()->first);
+    TEST_ASSERT_EQUAL_UINT32(2, firebase.updates);
+}
+
+/****** replay batches ******/
+
+void test_replay_is_oldest_first_in_batches()
+{
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        append(START + i * SAMPLE_INTERVAL_S);
+    }
+    OutboxBatch batch = drain();
+    TEST_ASSERT_EQUAL_UINT32(BATCH, batch.taken);
+    TEST_ASSERT_EQUAL_UINT32(START + (BATCH - 1) * SAMPLE_INTERVAL_S, batch.newestEpoch);
+    TEST_ASSERT_EQUAL_UINT32(START, firebase.history.begin()->first);
+    TEST_ASSERT_EQUAL_UINT32(20 - BATCH, outbox.ring.count);
+}
+
+void test_full_payload_ends_batch_early()
+{
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        append(START + i * SAMPLE_INTERVAL_S);
+    }
+    OutboxBatch batch = drain(3);
+    TEST_ASSERT_EQUAL_UINT32(3, batch.taken);
+    TEST_ASSERT_EQUAL_UINT32(2, outbox.ring.count);
+}
+
+void test_corrupt_record_is_skipped()
+{
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        append(START + i * SAMPLE_INTERVAL_S);
+    }
+    outbox.slots[outboxRingSlot(outbox.ring, 1)].centi[2] ^= 0x40; // Torn write
+    OutboxBatch batch = drain();
+    TEST_ASSERT_EQUAL_UINT32(3, batch.taken);
+    TEST_ASSERT_EQUAL_UINT32(2, batch.sent);
+    TEST_ASSERT_EQUAL_UINT32(1, batch.corrupt);
+    TEST_ASSERT_EQUAL_UINT32(0, outbox.ring.count);
+    TEST_ASSERT_TRUE(firebase.history.find(START + SAMPLE_INTERVAL_S) == firebase.history.end());
+}
+
+void test_only_corrupt_records_drop_without_update()
+{
+    append(START);
+    outbox.slots[0].epoch ^= 1;
+    firebase.online = false;
+    OutboxBatch batch = drain();
+    TEST_ASSERT_EQUAL_UINT32(0, batch.sent);
+    TEST_ASSERT_EQUAL_UINT32(0, outbox.ring.count);
+    TEST_ASSERT_EQUAL_UINT32(0, firebase.rejected);
+}
+
+/****** backoff ******/
+
+void test_backoff_doubles_to_cap_and_resets()
+{
+    uint32_t interval = BASE_INTERVAL_MS;
+    for (int i = 0; i < 10; i++)
+    {
+        interval = outboxNextInterval(interval, false, BASE_INTERVAL_MS, MAX_INTERVAL_MS);
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(MAX_INTERVAL_MS, interval);
+    TEST_ASSERT_LESS_THAN(2 * MAX_INTERVAL_MS, interval);
+    TEST_ASSERT_EQUAL_UINT32(BASE_INTERVAL_MS, outboxNextInterval(interval, true, BASE_INTERVAL_MS, MAX_INTERVAL_MS));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_outage_leaves_no_holes);
+    RUN_TEST(test_failed_update_keeps_records);
+    RUN_TEST(test_outage_longer_than_ring_keeps_newest);
+    RUN_TEST(test_replay_is_oldest_first_in_batches);
+    RUN_TEST(test_full_payload_ends_batch_early);
+    RUN_TEST(test_corrupt_record_is_skipped);
+    RUN_TEST(test_only_corrupt_records_drop_without_update);
+    RUN_TEST(test_backoff_doubles_to_cap_and_resets);
+    return UNITY_END();
+}
@@ -0,0 +1,169 @@
+// ==================================================
+// File: test/test_safety/test_main.cpp
+// ==================================================
+// Host tests for the safety cutout checks in SafetyMath.h.
+// Run with: pio test -e native -f test_safety
+
+#include <unity.h>
+#include "SafetyMath.h"
+
+static const SafetyLimits LIMITS = {40.0f, 4UL * 60UL * 60UL * 1000UL, 30000UL};
+
+static SafetyState state;
+static float temps[3];
+static bool valid[3];
+
+void setUp()
+{
+    safetyInit(state, 0);
+    for (int i = 0; i < 3; i++)
+    {
+        temps[i] = 20.0f;
+        valid[i] = true;
+    }
+}
+
+void tearDown() {}
+
+static uint8_t step(bool relayOn, uint32_t nowMs)
+{
+    return safetyEvaluate(state, LIMITS, temps, valid, 3, relayOn, nowMs);
+}
+
+/****** over-temperature ******/
+
+void test_normal_readings_do_not_trip()
+{
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(true, 1000));
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(false, 2000));
+}
+
+void test_over_temp_trips_on_any_probe()
+{
+    temps[2] = 40.0f;
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_OVER_TEMP, step(false, 1000));
+}
+
+void test_over_temp_ignores_invalid_probe()
+{
+    temps[1] = 85.0f; // DS18B20 power-on value
+    valid[1] = false;
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(false, 1000));
+}
+
+/****** maximum on-time ******/
+
+void test_max_on_time_trips_after_limit()
+{
+    step(true, 1000);
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(true, 1000 + LIMITS.maxOnMs - 1));
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_MAX_ON_TIME, step(true, 1000 + LIMITS.maxOnMs));
+}
+
+void test_max_on_time_restarts_when_relay_cycles()
+{
+    step(true, 0);
+    step(true, LIMITS.maxOnMs - 1000);
+    step(false, LIMITS.maxOnMs - 500);
+    step(true, LIMITS.maxOnMs);
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(true, LIMITS.maxOnMs + 60000));
+}
+
+/****** sensor lost ******/
+
+void test_sensor_lost_after_timeout()
+{
+    step(false, 1000);
+    for (int i = 0; i < 3; i++)
+    {
+        valid[i] = false;
+    }
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(false, 1000 + LIMITS.sensorTimeoutMs - 1));
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_SENSOR_LOST, step(false, 1000 + LIMITS.sensorTimeoutMs));
+}
+
+void test_one_valid_probe_keeps_sensor_alive()
+{
+    valid[0] = false;
+    valid[1] = false;
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(false, LIMITS.sensorTimeoutMs * 10));
+}
+
+/****** latch / reset ******/
+
+void test_fault_stays_latched_after_condition_clears()
+{
+    temps[0] = 45.0f;
+    step(false, 1000);
+    temps[0] = 20.0f;
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_OVER_TEMP, step(false, 2000));
+}
+
+void test_reset_clears_latch()
+{
+    temps[0] = 45.0f;
+    step(false, 1000);
+    temps[0] = 20.0f;
+    safetyReset(state, 2000);
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(false, 3000));
+}
+
+void test_reset_retrips_if_condition_persists()
+{
+    temps[0] = 45.0f;
+    step(false, 1000);
+    safetyReset(state, 2000);
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_OVER_TEMP, step(false, 3000));
+}
+
+void test_reset_restarts_on_time()
+{
+    step(true, 0);
+    step(true, LIMITS.maxOnMs);
+    safetyReset(state, LIMITS.maxOnMs + 1000);
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(true, LIMITS.maxOnMs + 2000));
+}
+
+/****** millis() wrap ******/
+
+void test_on_time_across_millis_wrap()
+{
+    const uint32_t start = 0xFFFFFFFFUL - 60000UL; // One minute before wrap
+    safetyInit(state, start);
+    step(true, start);
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(true, (uint32_t)(start + 120000UL))); // Wrapped
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(true, (uint32_t)(start + LIMITS.maxOnMs - 1)));
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_MAX_ON_TIME, step(true, (uint32_t)(start + LIMITS.maxOnMs)));
+}
+
+void test_sensor_timeout_across_millis_wrap()
+{
+    const uint32_t start = 0xFFFFFFFFUL - 5000UL;
+    safetyInit(state, start);
+    step(false, start);
+    for (int i = 0; i < 3; i++)
+    {
+        valid[i] = false;
+    }
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_NONE, step(false, (uint32_t)(start + 10000UL)));
+    TEST_ASSERT_EQUAL_UINT8(SAFETY_FAULT_SENSOR_LOST, step(false, (uint32_t)(start + LIMITS.sensorTimeoutMs)));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_normal_readings_do_not_trip);
+    RUN_TEST(test_over_temp_trips_on_any_probe);
+    RUN_TEST(test_over_temp_ignores_invalid_probe);
+    RUN_TEST(test_max_on_time_trips_after_limit);
+    RUN_TEST(test_max_on_time_restarts_when_relay_cycles);
+    RUN_TEST(test_sensor_lost_after_timeout);
+    RUN_TEST(test_one_valid_probe_keeps_sensor_alive);
+    RUN_TEST(test_fault_stays_latched_after_condition_clears);
+    RUN_TEST(test_reset_clears_latch);
+    RUN_TEST(test_reset_retrips_if_condition_persists);
+    RUN_TEST(test_reset_restarts_on_time);
+    RUN_TEST(test_on_time_across_millis_wrap);
+    RUN_TEST(test_sensor_timeout_across_millis_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,215 @@
+// ==================================================
+// File: test/test_thermal/test_main.cpp
+// ==================================================
+// Host simulation of the learned thermal model in ThermalMath.h: fit it
+// online from a simulated enclosure under the daily schedule, then compare
+// how close to the scheduled time the day setpoint is reached with and
+// without predictive pre-heating.
+// Run with: pio test -e native -f test_thermal -v   (-v prints the result)
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "ThermalMath.h"
+#include "PiControl.h"
+
+// ThermalPredictor.h defaults
+#define SAMPLE_INTERVAL_S 60
+#define FORGETTING 0.995f
+#define MIN_SAMPLES 120
+#define MAX_LEAD_S 7200
+#define MARGIN 1.15f
+
+// Simulated enclosure, dT/dt = a*u - b*(T - ambient)
+static const float TRUE_A = 10.0f;  // °C/h at full power
+static const float TRUE_B = 0.45f;  // 1/h
+static const float AMBIENT = 22.0f; // Blue/green probes
+
+static const float NIGHT_C = 24.0f;
+static const float DAY_C = 30.0f;
+static const uint32_t DAY_START_S = 8 * 3600;
+static const uint32_t NIGHT_START_S = 22 * 3600;
+static const uint32_t DAY_S = 86400;
+
+static float quantise(float t)
+{
+    return roundf(t * 16.0f) / 16.0f; // DS18B20 at 12 bits
+}
+
+// updateThermalPredictor(): one model update per sample interval from the
+// observed rate of change and the relay duty over it
+struct Sampler
+{
+    uint32_t start;
+    float startTemp;
+    uint32_t decisions;
+    uint32_t onDecisions;
+};
+
+static void sample(ThermalModel &model, Sampler &s, uint32_t t, float measured, bool relayOn)
+{
+    if (isnan(s.startTemp))
+    {
+        s.start = t;
+        s.startTemp = measured;
+        return;
+    }
+    s.decisions++;
+    s.onDecisions += relayOn ? 1 : 0;
+    if (t - s.start < SAMPLE_INTERVAL_S)
+    {
+        return;
+    }
+    float hours = (t - s.start) / 3600.0f;
+    thermalUpdate(model, (measured - s.startTemp) / hours, (float)s.onDecisions / s.decisions,
+                  (measured + s.startTemp) / 2.0f - AMBIENT);
+    s.start = t;
+    s.startTemp = measured;
+    s.decisions = 0;
+    s.onDecisions = 0;
+}
+
+struct Arrival
+{
+    float lateS; // Reaching the day setpoint minus the scheduled time; negative = early
+};
+
+// Runs `days` days of the schedule under hysteresis control and returns
+// the arrival at the day setpoint on the last day
+static Arrival runSchedule(ThermalModel &model, uint32_t days, bool preheat)
+{
+    float temp = NIGHT_C;
+    Sampler sampler = {0, NAN, 0, 0};
+    bool relay = false;
+    bool preheating = false;
+    Arrival arrival = {NAN};
+
+    for (uint32_t t = 0; t < days * DAY_S; t++)
+    {
+        uint32_t timeOfDay = t % DAY_S;
+        bool day = timeOfDay >= DAY_START_S && timeOfDay < NIGHT_START_S;
+        float target = day ? DAY_C : NIGHT_C;
+        float measured = quantise(temp);
+
+        // Pre-heat: move to the day setpoint once the lead covers the time left
+        if (preheat && !day && timeOfDay < DAY_START_S && !preheating &&
+            model.samples >= MIN_SAMPLES)
+        {
+            uint32_t lead = thermalLeadSeconds(model, measured, DAY_C, AMBIENT, MAX_LEAD_S);
+            lead = (uint32_t)(lead * MARGIN);
+            preheating = lead >= DAY_START_S - timeOfDay;
+        }
+        if (day || timeOfDay >= NIGHT_START_S)
+        {
+            preheating = false;
+        }
+        if (preheating)
+        {
+            target = DAY_C;
+        }
+
+        HeaterDemand demand = hysteresisDemand(measured, target, HYSTERESIS_BAND);
+        if (demand != DEMAND_HOLD)
+        {
+            relay = demand == DEMAND_ON;
+        }
+        sample(model, sampler, t, measured, relay);
+
+        bool lastDay = t >= (days - 1) * DAY_S;
+        if (lastDay && isnan(arrival.lateS) && temp >= DAY_C - 0.1f && timeOfDay > DAY_START_S - MAX_LEAD_S)
+        {
+            arrival.lateS = (float)timeOfDay - (float)DAY_START_S;
+        }
+
+        float rate = TRUE_A * (relay ? 1.0f : 0.0f) - TRUE_B * (temp - AMBIENT);
+        temp += rate / 3600.0f;
+    }
+    return arrival;
+}
+
+static ThermalModel model;
+static Arrival scheduled;
+static Arrival predicted;
+
+void setUp() {}
+void tearDown() {}
+
+void test_model_is_learned_from_the_schedule()
+{
+    thermalInit(model, 10.0f, 0.5f, FORGETTING); // ThermalPredictor's starting guess
+    model.a = 5.0f;                              // Start well off the true values
+    model.b = 1.0f;
+    runSchedule(model, 3, false);
+    char line[96];
+    snprintf(line, sizeof(line), "fit a=%.2f C/h (true %.2f)  b=%.3f /h (true %.3f)  samples=%u",
+             model.a, TRUE_A, model.b, TRUE_B, (unsigned)model.samples);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_GREATER_OR_EQUAL(MIN_SAMPLES, model.samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f * TRUE_A, TRUE_A, model.a);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f * TRUE_B, TRUE_B, model.b);
+}
+
+void test_preheat_improves_on_time_accuracy()
+{
+    ThermalModel fixed = model; // Learned above
+    scheduled = runSchedule(fixed, 1, false);
+    ThermalModel learning = model;
+    predicted = runSchedule(learning, 2, true);
+
+    char line[96];
+    snprintf(line, sizeof(line), "day setpoint reached: %+.0f s without pre-heat, %+.0f s with",
+             scheduled.lateS, predicted.lateS);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_FALSE(isnan(scheduled.lateS));
+    TEST_ASSERT_FALSE(isnan(predicted.lateS));
+    TEST_ASSERT_GREATER_THAN(1800.0f, scheduled.lateS); // Tens of minutes late
+    // PREHEAT_MARGIN errs on the early side: never late, and within 15 min
+    TEST_ASSERT_LESS_OR_EQUAL(60.0f, predicted.lateS);
+    TEST_ASSERT_LESS_THAN(900.0f, fabsf(predicted.lateS));
+    TEST_ASSERT_LESS_THAN(fabsf(scheduled.lateS) / 3.0f, fabsf(predicted.lateS));
+}
+
+// Hours with the relay never switching inflate the covariance; the fit
+// must keep counting samples and still converge afterwards
+void test_fit_survives_a_long_unexcited_period()
+{
+    ThermalModel m;
+    thermalInit(m, TRUE_A, TRUE_B, FORGETTING);
+    for (int i = 0; i < 2000; i++)
+    {
+        thermalUpdate(m, 0.0f, 0.0f, 0.0f);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2000, m.samples);
+    TEST_ASSERT_LESS_OR_EQUAL(THERMAL_MAX_COVARIANCE * 1.001f, m.p[0][0] + m.p[1][1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, TRUE_A, m.a);
+
+    float temp = 26.0f;
+    for (int i = 0; i < 600; i++)
+    {
+        float duty = (i / 10) % 2 ? 1.0f : 0.0f;
+        float rate = TRUE_A * duty - TRUE_B * (temp - AMBIENT);
+        thermalUpdate(m, rate, duty, temp + rate / 120.0f - AMBIENT);
+        temp += rate / 60.0f;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * TRUE_A, TRUE_A, m.a);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * TRUE_B, TRUE_B, m.b);
+}
+
+void test_lead_for_unreachable_target_is_capped()
+{
+    ThermalModel m;
+    thermalInit(m, TRUE_A, TRUE_B, FORGETTING);
+    // Full power levels off at AMBIENT + a/b = 44.2 °C
+    TEST_ASSERT_EQUAL_UINT32(MAX_LEAD_S, thermalLeadSeconds(m, 30.0f, 50.0f, AMBIENT, MAX_LEAD_S));
+    TEST_ASSERT_EQUAL_UINT32(0, thermalLeadSeconds(m, 30.0f, 28.0f, AMBIENT, MAX_LEAD_S));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_model_is_learned_from_the_schedule);
+    RUN_TEST(test_preheat_improves_on_time_accuracy);
+    RUN_TEST(test_fit_survives_a_long_unexcited_period);
+    RUN_TEST(test_lead_for_unreachable_target_is_capped);
+    return UNITY_END();
+}